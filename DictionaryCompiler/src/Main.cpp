@@ -0,0 +1,131 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Offline compiler from a word list to a lexicon image and a leave table
+ */
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "ScrabbleCore.h"
+
+namespace {
+	/**
+	 * Writes a file in full before it replaces the previous one
+	 *
+	 * @param target is the location of the file
+	 * @param bytes is the new contents of the file
+	 * @return false if the file could not be written
+	 */
+	bool replaceFile(_In_ std::filesystem::path const& target,
+		_In_ std::vector<char> const& bytes) {
+		std::filesystem::path partial = target;
+		partial += L".partial";
+		{
+			std::ofstream file(partial, std::ios::binary | std::ios::trunc);
+			file.write(bytes.data(), static_cast<std::streamsize>(
+				bytes.size()));
+			if (!file.flush())
+				return false;
+		}
+
+		std::error_code error;
+		std::filesystem::rename(partial, target, error);
+		if (error) {
+			std::filesystem::remove(partial, error);
+			return false;
+		}
+
+		return true;
+	}
+}
+
+/**
+ * Program entry-point
+ *
+ * The word list is indexed exactly as it would be at startup, and every
+ * index is then written out as an image that the solvers can map directly.
+ * An alphabet can be named first, which the words are then spelled with
+ * instead of the letters A to Z, and which is stored in the image. If a
+ * third file is named, the value of every rack leave is computed from the
+ * word list and written there as well, which needs the classic alphabet.
+ * Each image is read back before it is written, and the previous one is
+ * only replaced once the new one has been written in full, so a failed run
+ * never leaves a broken image behind.
+ *
+ * @param argc is the number of arguments
+ * @param argv contains the arguments
+ * @return exit status, which is 1 for bad arguments and 2 if the word list
+ *         cannot be read or an image cannot be written
+ */
+int wmain(_In_ int argc, _In_reads_(argc) wchar_t* argv[]) {
+	Alphabet alphabet;
+	if (argc >= 3 && std::wstring_view(argv[1]) == L"--alphabet") {
+		alphabet = loadAlphabet(argv[2]);
+		if (alphabet.empty()) {
+			fputs("Could not load the alphabet\n", stderr);
+			return 2;
+		}
+
+		argc -= 2;
+		argv += 2;
+	}
+
+	if (argc != 3 && argc != 4) {
+		fputs("Usage: DictionaryCompiler [--alphabet <file>] <word list> "
+			"<image> [<leave table>]\n", stderr);
+		return 1;
+	}
+
+	if (argc == 4 && !alphabet.classic()) {
+		fputs("Leave tables need the classic alphabet\n", stderr);
+		return 1;
+	}
+
+	Dictionary dictionary = loadDictionary(argv[1]);
+	if (dictionary.empty()) {
+		fputs("Could not load the word list\n", stderr);
+		return 2;
+	}
+
+	Lexicon lexicon(std::move(dictionary), std::move(alphabet));
+	size_t words = lexicon.dictionary().size();
+	std::vector<char> image = LexiconImage::compile(lexicon);
+	if (LexiconImage::open(image.data(), image.size()).dictionary().size()
+		!= words) {
+		fputs("Could not read back the compiled image\n", stderr);
+		return 2;
+	}
+
+	if (!replaceFile(argv[2], image)) {
+		fputs("Could not write the image\n", stderr);
+		return 2;
+	}
+
+	fprintf(stderr, "Compiled %zu words into %zu bytes\n", words,
+		image.size());
+	if (argc == 3)
+		return 0;
+
+	LeaveTable leaves(lexicon.index());
+	std::vector<char> table = leaves.compile();
+	if (LeaveTable::open(table.data(), table.size()).size()
+		!= leaves.size()) {
+		fputs("Could not read back the leave table\n", stderr);
+		return 2;
+	}
+
+	if (!replaceFile(argv[3], table)) {
+		fputs("Could not write the leave table\n", stderr);
+		return 2;
+	}
+
+	fprintf(stderr, "Valued %zu leaves in %zu bytes\n", leaves.size(),
+		table.size());
+	return 0;
+}
@@ -0,0 +1,670 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Benchmark of every search engine against a fixed corpus of queries, and
+ * of the move generator over a fixed game
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cwchar>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <windows.h>
+
+#include "Resources.h"
+#include "ScrabbleCore.h"
+
+namespace {
+	/**
+	 * Number of heap allocations made by the whole program so far
+	 */
+	std::atomic<uint64_t> allocations = 0;
+}
+
+/**
+ * Allocates memory, counting every call
+ *
+ * Array allocations are forwarded here by the runtime, so this counts them
+ * too.
+ *
+ * @param size is the number of bytes to allocate
+ * @return allocated memory
+ */
+void* operator new(size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	void* memory = malloc(size ? size : 1);
+	if (!memory)
+		throw std::bad_alloc();
+
+	return memory;
+}
+
+/**
+ * Frees memory taken by operator new
+ *
+ * @param memory is the memory to free
+ */
+void operator delete(_In_opt_ void* memory) noexcept {
+	free(memory);
+}
+
+/**
+ * Frees memory taken by operator new
+ *
+ * @param memory is the memory to free
+ * @param size is the number of bytes that were allocated
+ */
+void operator delete(_In_opt_ void* memory, _In_ size_t size) noexcept {
+	(void) size;
+	free(memory);
+}
+
+/**
+ * Settings given on the command line
+ */
+struct Options {
+	wchar_t const* dictionary = nullptr;
+	wchar_t const* output = L"Benchmark.json";
+	size_t repeat = 5;
+};
+
+/**
+ * Largest number of timed passes, which keeps the latencies of every solve
+ * well within memory
+ */
+constexpr size_t MaxRepeat = 1000;
+
+/**
+ * Query of the corpus, owning its letters, filters, pattern and tiles on
+ * the board
+ */
+struct Entry {
+	std::string letters;
+	std::string startsWith;
+	std::string endsWith;
+	std::string contains;
+	std::string pattern;
+	std::string through;
+	size_t offset = Gaddag::Anywhere;
+	bool hook = false;
+};
+
+/**
+ * Named group of queries that stress one part of solving
+ */
+struct Corpus {
+	char const* name;
+	std::vector<Entry> entries;
+};
+
+/**
+ * Engine that is measured, with the name it is reported under
+ */
+struct Contender {
+	Engine engine;
+	char const* name;
+};
+
+/**
+ * Measurements of one engine over one corpus
+ */
+struct Result {
+	char const* engine;
+	char const* corpus;
+	size_t queries;
+	double median;
+	double p99;
+	double qps;
+	double allocations;
+	size_t matches;
+};
+
+/**
+ * Seed of the generator the corpus is drawn with
+ *
+ * Changing it, or the way racks are drawn, changes the corpus, which makes
+ * results incomparable with earlier ones.
+ */
+constexpr uint32_t Seed = 20230101;
+
+/**
+ * Number of queries in each corpus
+ */
+constexpr size_t CorpusSize = 64;
+
+/**
+ * Number of games the move generator plays, and of turns in each
+ */
+constexpr size_t Games = 4;
+constexpr size_t GameTurns = 16;
+
+/**
+ * Letters of a standard bag without its two blanks
+ */
+constexpr std::string_view Bag = "AAAAAAAAABBCCDDDDEEEEEEEEEEEEFFGGGHHIIII"
+	"IIIIIJKLLLLMMNNNNNNOOOOOOOOPPQRRRRRRSSSSTTTTTTUUUUVVWWXYYZ";
+
+/**
+ * Common beginnings, endings and fragments used by the filtered corpora
+ */
+constexpr std::string_view Prefixes[] = {
+	"RE", "UN", "C", "ST", "PRE", "A", "DIS", "OVER"
+};
+constexpr std::string_view Suffixes[] = {
+	"ING", "S", "ED", "ER", "TION", "LY", "NESS", "EST"
+};
+constexpr std::string_view Fragments[] = {
+	"QU", "ATE", "ION", "OU", "EA", "TT", "ZZ", "RR"
+};
+
+/**
+ * Patterns used by the pattern corpus, both fixed at the start and open
+ */
+constexpr std::string_view Patterns[] = {
+	"?A??ER", "*ING", "[AEIOU]{2}*", "RE*[^S]", "?{2,4}", "C*T{0,2}S",
+	"*E?", "S[^AEIOU]*"
+};
+
+/**
+ * Words on the board that the hooks corpus extends
+ */
+constexpr std::string_view Played[] = {
+	"CAT", "RAIN", "HOP", "STAR", "ONE", "LATE", "PART", "AT"
+};
+
+/**
+ * Every engine, with automatic selection last
+ */
+constexpr Contender Contenders[] = {
+	{ Engine::Scan, "scan" },
+	{ Engine::Signature, "signature" },
+	{ Engine::Dawg, "dawg" },
+	{ Engine::Substring, "substring" },
+	{ Engine::Gaddag, "gaddag" },
+	{ Engine::Bitset, "bitset" },
+	{ Engine::Automatic, "automatic" }
+};
+
+/**
+ * Prints how the program is used
+ */
+void printUsage() {
+	fputs("Usage: ScrabbleBenchmark [options]\n"
+		"\n"
+		"Solves a fixed corpus of queries with every engine, and plays fixed\n"
+		"games with the move generator, then reports the latency, throughput\n"
+		"and allocations of each.\n"
+		"\n"
+		"Options:\n"
+		"  --dictionary <file>  use a word list or compiled image instead of the\n"
+		"                       built-in one\n"
+		"  --output <file>      file the results are written to as JSON,\n"
+		"                       Benchmark.json by default\n"
+		"  --repeat <count>     number of timed passes over the corpus, from\n"
+		"                       1 to 1000, 5 by default\n", stderr);
+}
+
+/**
+ * Reads the command-line arguments
+ *
+ * @param argc is the number of arguments
+ * @param argv contains the arguments
+ * @param options receives the settings
+ * @return false if the arguments are not valid
+ */
+bool parseOptions(_In_ int argc, _In_reads_(argc) wchar_t* argv[],
+	_Out_ Options& options) {
+	options = {};
+	for (int i = 1; i < argc; ++i) {
+		std::wstring_view argument = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (argument == L"--dictionary" && hasValue) {
+			options.dictionary = argv[++i];
+		} else if (argument == L"--output" && hasValue) {
+			options.output = argv[++i];
+		} else if (argument == L"--repeat" && hasValue) {
+			wchar_t const* value = argv[++i];
+			if (*value < L'0' || *value > L'9')
+				return false;
+
+			wchar_t* end = nullptr;
+			errno = 0;
+			unsigned long repeat = wcstoul(value, &end, 10);
+			if (*end || errno == ERANGE || !repeat || repeat > MaxRepeat)
+				return false;
+
+			options.repeat = repeat;
+		} else {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Draws tiles from a full bag
+ *
+ * Only the raw output of the generator is used, as its sequence is fixed by
+ * the standard while the distributions are left to each library, so the
+ * corpus is the same with every compiler.
+ *
+ * @param random is the generator tiles are drawn with
+ * @param letters is the number of lettered tiles to draw
+ * @param blanks is the number of blanks to add
+ * @return drawn tiles, with blanks written as question marks
+ */
+std::string drawRack(_Inout_ std::mt19937& random, _In_ size_t letters,
+	_In_ size_t blanks) {
+	std::string bag(Bag);
+	std::string rack;
+	for (size_t i = 0; i < letters && !bag.empty(); ++i) {
+		size_t tile = random() % bag.length();
+		rack.push_back(bag[tile]);
+		bag.erase(tile, 1);
+	}
+
+	rack.append(blanks, '?');
+	return rack;
+}
+
+/**
+ * Generates the corpus of queries
+ *
+ * Plain racks have seven tiles with up to three blanks, long racks have
+ * fifteen and the filtered corpora add the tiles their filters need to a
+ * seven tile rack, so each filter can match. The pattern corpus pairs
+ * seven tile racks with patterns. The through corpus plays a seven tile
+ * rack through one tile on the board a few letters into the word, and the
+ * hooks corpus extends a word on the board with it. Each corpus is drawn
+ * after the ones before it, so adding one leaves the others the same.
+ *
+ * @return every corpus, always the same
+ */
+std::vector<Corpus> buildCorpus() {
+	std::mt19937 random(Seed);
+	std::vector<Corpus> corpus = {
+		{ "blanks0", {} }, { "blanks1", {} }, { "blanks2", {} },
+		{ "blanks3", {} }, { "long", {} }, { "startsWith", {} },
+		{ "endsWith", {} }, { "contains", {} }, { "combined", {} },
+		{ "pattern", {} }, { "through", {} }, { "hooks", {} }
+	};
+
+	for (size_t blanks = 0; blanks <= 3; ++blanks) {
+		for (size_t i = 0; i < CorpusSize; ++i) {
+			corpus[blanks].entries.push_back({ drawRack(random,
+				Board::RackSize - blanks, blanks), {}, {}, {}, {} });
+		}
+	}
+
+	for (size_t i = 0; i < CorpusSize; ++i) {
+		size_t blanks = random() % 3;
+		corpus[4].entries.push_back({ drawRack(random, 15 - blanks, blanks),
+			{}, {}, {}, {} });
+	}
+
+	for (size_t i = 0; i < CorpusSize; ++i) {
+		std::string_view prefix = Prefixes[random() % std::size(Prefixes)];
+		std::string_view suffix = Suffixes[random() % std::size(Suffixes)];
+		std::string_view fragment =
+			Fragments[random() % std::size(Fragments)];
+		size_t blanks = random() % 2;
+		std::string rack = drawRack(random, Board::RackSize - blanks, blanks);
+
+		corpus[5].entries.push_back({ rack + std::string(prefix),
+			std::string(prefix), {}, {}, {} });
+		corpus[6].entries.push_back({ rack + std::string(suffix), {},
+			std::string(suffix), {}, {} });
+		corpus[7].entries.push_back({ rack + std::string(fragment), {}, {},
+			std::string(fragment), {} });
+		corpus[8].entries.push_back({ rack + std::string(prefix)
+			+ std::string(suffix), std::string(prefix), std::string(suffix),
+			{}, {} });
+	}
+
+	for (size_t i = 0; i < CorpusSize; ++i) {
+		std::string_view pattern = Patterns[random() % std::size(Patterns)];
+		size_t blanks = random() % 3;
+		corpus[9].entries.push_back({ drawRack(random,
+			Board::RackSize - blanks, blanks), {}, {}, {},
+			std::string(pattern) });
+	}
+
+	for (size_t i = 0; i < CorpusSize; ++i) {
+		size_t blanks = random() % 2;
+		std::string rack = drawRack(random, Board::RackSize - blanks, blanks);
+		std::string tile(1, Bag[random() % Bag.length()]);
+		corpus[10].entries.push_back({ rack, {}, {}, {}, {}, tile,
+			random() % 4 });
+	}
+
+	for (size_t i = 0; i < CorpusSize; ++i) {
+		std::string_view word = Played[random() % std::size(Played)];
+		size_t blanks = random() % 2;
+		corpus[11].entries.push_back({ drawRack(random,
+			Board::RackSize - blanks, blanks), {}, {}, {}, {},
+			std::string(word), Gaddag::Anywhere, true });
+	}
+
+	return corpus;
+}
+
+/**
+ * Draws the racks of the games the move generator plays
+ *
+ * Every turn is a fresh seven tile rack with up to one blank. The racks are
+ * drawn from a generator of their own, so the query corpus stays the same.
+ *
+ * @return rack of every turn of every game, always the same
+ */
+std::vector<std::string> buildGames() {
+	std::mt19937 random(Seed);
+	std::vector<std::string> racks;
+	for (size_t i = 0; i < Games * GameTurns; ++i) {
+		size_t blanks = random() % 2;
+		racks.push_back(drawRack(random, Board::RackSize - blanks, blanks));
+	}
+
+	return racks;
+}
+
+/**
+ * Finds a percentile of sorted samples by the nearest rank
+ *
+ * @param samples are the samples in increasing order, of which there must
+ *        be at least one
+ * @param percentile is the percentile to find, from 0 to 100
+ * @return smallest sample with at least that percent of samples at or below
+ *         it
+ */
+double percentile(_In_ std::vector<double> const& samples,
+	_In_ double percentile) {
+	size_t rank = static_cast<size_t>(
+		percentile / 100 * static_cast<double>(samples.size()) + 0.999999);
+	return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+}
+
+/**
+ * Summarizes the latencies of an engine over a corpus
+ *
+ * @param engine is the name of the engine
+ * @param corpus is the name of the corpus
+ * @param queries is the number of distinct queries that were solved
+ * @param latencies are the times of every solve in microseconds, which are
+ *        sorted
+ * @param allocated is the number of allocations over every solve
+ * @param matches is the number of matches over one pass of the queries
+ * @return summary of the measurements
+ */
+Result summarize(_In_ char const* engine, _In_ char const* corpus,
+	_In_ size_t queries, _Inout_ std::vector<double>& latencies,
+	_In_ uint64_t allocated, _In_ size_t matches) {
+	double total = 0;
+	for (double latency : latencies)
+		total += latency;
+
+	std::sort(latencies.begin(), latencies.end());
+	double solves = static_cast<double>(latencies.size());
+	return { engine, corpus, queries, percentile(latencies, 50),
+		percentile(latencies, 99), total > 0 ? solves * 1e6 / total : 0,
+		static_cast<double>(allocated) / solves, matches };
+}
+
+/**
+ * Solves every query of a corpus with one engine and times each solve
+ *
+ * One untimed pass is made first to warm the caches and the workspace, and
+ * it also counts the matches so engines can be checked against each other.
+ *
+ * @param lexicon is the dictionary and its indexes
+ * @param workspace is the memory reused by every solve
+ * @param engine is the engine to solve with
+ * @param corpus is the group of queries to solve
+ * @param repeat is the number of timed passes
+ * @param latencies receives the time of every solve in microseconds
+ * @param allocated is increased by the allocations made by the timed passes
+ * @return number of matches found in one pass
+ */
+size_t measure(_In_ Lexicon const& lexicon, _Inout_ Workspace& workspace,
+	_In_ Engine engine, _In_ Corpus const& corpus, _In_ size_t repeat,
+	_Inout_ std::vector<double>& latencies, _Inout_ uint64_t& allocated) {
+	std::vector<Query> queries(corpus.entries.size());
+	std::vector<std::optional<Pattern>> patterns(queries.size());
+	for (size_t i = 0; i < queries.size(); ++i) {
+		queries[i].letters = corpus.entries[i].letters;
+		queries[i].startsWith = corpus.entries[i].startsWith;
+		queries[i].endsWith = corpus.entries[i].endsWith;
+		queries[i].contains = corpus.entries[i].contains;
+		queries[i].through = corpus.entries[i].through;
+		queries[i].offset = corpus.entries[i].offset;
+		queries[i].hook = corpus.entries[i].hook;
+		if (!corpus.entries[i].pattern.empty()) {
+			patterns[i].emplace(corpus.entries[i].pattern);
+			queries[i].pattern = &*patterns[i];
+		}
+
+		queries[i].method = SortingMethod::Points;
+		queries[i].engine = engine;
+	}
+
+	size_t matches = 0;
+	for (Query const& query : queries)
+		matches += solve(lexicon, query, workspace).size();
+
+	latencies.reserve(latencies.size() + repeat * queries.size());
+	for (size_t pass = 0; pass < repeat; ++pass) {
+		for (Query const& query : queries) {
+			uint64_t before = allocations.load(std::memory_order_relaxed);
+			auto start = std::chrono::steady_clock::now();
+			solve(lexicon, query, workspace);
+			auto stop = std::chrono::steady_clock::now();
+			allocated += allocations.load(std::memory_order_relaxed) - before;
+			latencies.push_back(std::chrono::duration<double, std::micro>(
+				stop - start).count());
+		}
+	}
+
+	return matches;
+}
+
+/**
+ * Plays the games with the move generator and times every turn
+ *
+ * Each game starts from an empty board, and the best move of every turn is
+ * played, so every pass plays the same games. One untimed pass is made
+ * first to warm the caches, and it also counts the moves.
+ *
+ * @param lexicon is the dictionary whose word graph the board checks words
+ *        against
+ * @param racks is the rack of every turn, GameTurns to a game
+ * @param repeat is the number of timed passes
+ * @param latencies receives the time of every turn in microseconds
+ * @param allocated is increased by the allocations made by the timed passes
+ * @return number of moves found in one pass
+ */
+size_t measureMoves(_In_ Lexicon const& lexicon,
+	_In_ std::vector<std::string> const& racks, _In_ size_t repeat,
+	_Inout_ std::vector<double>& latencies, _Inout_ uint64_t& allocated) {
+	Board board(lexicon.dawg());
+	size_t moves = 0;
+	latencies.reserve(latencies.size() + repeat * racks.size());
+	for (size_t pass = 0; pass <= repeat; ++pass) {
+		for (size_t turn = 0; turn < racks.size(); ++turn) {
+			if (turn % GameTurns == 0)
+				board.clear();
+
+			uint64_t before = allocations.load(std::memory_order_relaxed);
+			auto start = std::chrono::steady_clock::now();
+			std::vector<Move> found = generateMoves(board, racks[turn]);
+			auto stop = std::chrono::steady_clock::now();
+			if (pass) {
+				allocated +=
+					allocations.load(std::memory_order_relaxed) - before;
+				latencies.push_back(std::chrono::duration<double,
+					std::micro>(stop - start).count());
+			} else
+				moves += found.size();
+
+			if (!found.empty())
+				board.play(found.front());
+		}
+	}
+
+	return moves;
+}
+
+/**
+ * Writes the results as JSON
+ *
+ * @param path is the file to write
+ * @param lexicon is the dictionary that was searched
+ * @param options are the settings the benchmark ran with
+ * @param results are the measurements of every engine and corpus
+ * @return false if the file could not be written
+ */
+bool writeResults(_In_ wchar_t const* path, _In_ Lexicon const& lexicon,
+	_In_ Options const& options, _In_ std::vector<Result> const& results) {
+	std::string output;
+	char line[256] = {};
+
+	snprintf(line, sizeof(line), "{\n\t\"words\": %zu,\n\t\"seed\": %u,\n"
+		"\t\"repeat\": %zu,\n\t\"threads\": %u,\n\t\"results\": [\n",
+		lexicon.dictionary().size(), Seed, options.repeat,
+		std::max(std::thread::hardware_concurrency(), 1u));
+	output.append(line);
+
+	for (size_t i = 0; i < results.size(); ++i) {
+		Result const& result = results[i];
+		snprintf(line, sizeof(line), "\t\t{ \"engine\": \"%s\", "
+			"\"corpus\": \"%s\", \"queries\": %zu, \"medianUs\": %.3f, "
+			"\"p99Us\": %.3f, \"qps\": %.1f, \"allocationsPerQuery\": %.3f, "
+			"\"matches\": %zu }%s\n", result.engine, result.corpus,
+			result.queries, result.median, result.p99, result.qps,
+			result.allocations, result.matches,
+			i + 1 < results.size() ? "," : "");
+		output.append(line);
+	}
+
+	output.append("\t]\n}\n");
+
+	std::ofstream file(std::filesystem::path(path), std::ios::binary);
+	file.write(output.data(), static_cast<std::streamsize>(output.size()));
+	return static_cast<bool>(file);
+}
+
+/**
+ * Program entry-point
+ *
+ * Every index, including the GADDAG, is built before measuring so that no
+ * solve pays for building one. Each engine then solves each corpus through
+ * the same workspace, and a row is added per engine over the whole corpus.
+ * Engines that disagree on the number of matches for a corpus are reported,
+ * as the timings of a wrong engine mean nothing. Last, the move generator
+ * plays its games, unless the dictionary is spelled with another alphabet,
+ * which the board does not support.
+ *
+ * @param argc is the number of arguments
+ * @param argv contains the arguments
+ * @return exit status, which is 1 for bad arguments, 2 if the dictionary
+ *         cannot be read or the results cannot be written and 3 if engines
+ *         disagree
+ */
+int wmain(_In_ int argc, _In_reads_(argc) wchar_t* argv[]) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) {
+		printUsage();
+		return 1;
+	}
+
+	Lexicon lexicon = options.dictionary
+		? loadLexicon(options.dictionary)
+		: loadLexicon(GetModuleHandleW(nullptr), ID_DICTIONARY);
+	if (lexicon.dictionary().empty()) {
+		fputs("Could not load the dictionary\n", stderr);
+		return 2;
+	}
+
+	lexicon.gaddag();
+
+	std::vector<Corpus> corpus = buildCorpus();
+	std::vector<Result> results;
+	std::vector<size_t> expected(corpus.size());
+	bool agree = true;
+	Workspace workspace;
+
+	printf("%-10s %-10s %8s %12s %12s %12s %12s\n", "engine", "corpus",
+		"queries", "median us", "p99 us", "qps", "allocations");
+	for (Contender const& contender : Contenders) {
+		std::vector<double> all;
+		uint64_t allAllocated = 0;
+		size_t allQueries = 0;
+		size_t allMatches = 0;
+
+		for (size_t i = 0; i < corpus.size(); ++i) {
+			std::vector<double> latencies;
+			uint64_t allocated = 0;
+			size_t matches = measure(lexicon, workspace, contender.engine,
+				corpus[i], options.repeat, latencies, allocated);
+
+			if (&contender == Contenders)
+				expected[i] = matches;
+			else if (matches != expected[i]) {
+				fprintf(stderr, "%s found %zu matches in %s instead of %zu\n",
+					contender.name, matches, corpus[i].name, expected[i]);
+				agree = false;
+			}
+
+			all.insert(all.end(), latencies.begin(), latencies.end());
+			allAllocated += allocated;
+			allQueries += corpus[i].entries.size();
+			allMatches += matches;
+			results.push_back(summarize(contender.name, corpus[i].name,
+				corpus[i].entries.size(), latencies, allocated, matches));
+		}
+
+		results.push_back(summarize(contender.name, "all", allQueries, all,
+			allAllocated, allMatches));
+		for (size_t i = results.size() - corpus.size() - 1;
+			i < results.size(); ++i) {
+			Result const& result = results[i];
+			printf("%-10s %-10s %8zu %12.1f %12.1f %12.0f %12.2f\n",
+				result.engine, result.corpus, result.queries, result.median,
+				result.p99, result.qps, result.allocations);
+		}
+	}
+
+	if (lexicon.alphabet().classic()) {
+		std::vector<std::string> racks = buildGames();
+		std::vector<double> latencies;
+		uint64_t allocated = 0;
+		size_t moves = measureMoves(lexicon, racks, options.repeat,
+			latencies, allocated);
+		Result const& result = results.emplace_back(summarize("moves",
+			"game", racks.size(), latencies, allocated, moves));
+		printf("%-10s %-10s %8zu %12.1f %12.1f %12.0f %12.2f\n",
+			result.engine, result.corpus, result.queries, result.median,
+			result.p99, result.qps, result.allocations);
+	}
+
+	if (!writeResults(options.output, lexicon, options, results)) {
+		fputs("Could not write the results\n", stderr);
+		return 2;
+	}
+
+	return agree ? 0 : 3;
+}
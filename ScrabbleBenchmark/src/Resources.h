@@ -0,0 +1,10 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Resource definitions
+ */
+
+#pragma once
+
+#define ID_DICTIONARY	102
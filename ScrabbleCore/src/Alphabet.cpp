@@ -0,0 +1,327 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Tiles of a language and the mapping from text onto them
+ */
+
+#include "Alphabet.h"
+
+#include <algorithm>
+#include <charconv>
+#include <memory>
+#include <utility>
+
+#include "Scoring.h"
+
+namespace {
+	/**
+	 * Character that a letter no tile spells is mapped to, which no word
+	 * holds and no pattern accepts
+	 */
+	constexpr char Unknown = '!';
+
+	/**
+	 * @param character is a byte of some text
+	 * @return true if the byte is an ASCII letter
+	 */
+	bool isLetter(_In_ char character) {
+		return (character >= 'A' && character <= 'Z')
+			|| (character >= 'a' && character <= 'z');
+	}
+
+	/**
+	 * @param lead is the first byte of a UTF-8 character
+	 * @return number of bytes in the character
+	 */
+	size_t sequenceLength(_In_ char lead) {
+		unsigned char code = static_cast<unsigned char>(lead);
+		if (code >= 0xF0)
+			return 4;
+		if (code >= 0xE0)
+			return 3;
+		if (code >= 0xC0)
+			return 2;
+		return 1;
+	}
+
+	/**
+	 * Checks whether some text starts with a spelling, ignoring the case of
+	 * ASCII letters
+	 *
+	 * @param text is the text to check
+	 * @param spelling is the spelling to look for
+	 * @return true if the text starts with the spelling
+	 */
+	bool startsWith(_In_ std::string_view text,
+		_In_ std::string_view spelling) {
+		if (text.length() < spelling.length())
+			return false;
+
+		for (size_t i = 0; i < spelling.length(); ++i) {
+			if (upper(text[i]) != upper(spelling[i]))
+				return false;
+		}
+
+		return true;
+	}
+
+	/**
+	 * Splits a line into the words between its spaces and tabs
+	 *
+	 * @param line is the line to split
+	 * @return words of the line
+	 */
+	std::vector<std::string_view> split(_In_ std::string_view line) {
+		std::vector<std::string_view> fields;
+		size_t begin = 0;
+		while (begin < line.length()) {
+			size_t end = line.find_first_of(" \t", begin);
+			if (end == std::string_view::npos)
+				end = line.length();
+			if (end > begin)
+				fields.push_back(line.substr(begin, end - begin));
+			begin = end + 1;
+		}
+
+		return fields;
+	}
+}
+
+/**
+ * Builds the classic alphabet of the letters A to Z, with the point values
+ * of the standard tile set
+ */
+Alphabet::Alphabet() : count(26), identity(true) {
+	for (size_t tile = 0; tile < count; ++tile) {
+		forms.push_back({ std::string(1, codeOf(tile)),
+			static_cast<uint8_t>(tile) });
+		values[tile] = Tiles<TileSet::Standard>::values[tile];
+	}
+}
+
+/**
+ * Reads an alphabet from its description
+ *
+ * The alphabet is classic if it has exactly the letters A to Z in order,
+ * each spelled only with itself, whatever their point values are. A byte
+ * order mark in front of the description is skipped.
+ *
+ * @param description is the text of the description, in UTF-8
+ * @return alphabet, or an empty alphabet if a line is malformed, a spelling
+ *         holds a character that is not a letter or is given twice, a tile
+ *         is worth no points or there are more than MaxTiles tiles
+ */
+Alphabet Alphabet::parse(_In_ std::string_view description) {
+	auto none = [] {
+		Alphabet empty;
+		empty.forms.clear();
+		empty.values = {};
+		empty.count = 0;
+		empty.identity = false;
+		return empty;
+	};
+
+	if (description.substr(0, 3) == "\xEF\xBB\xBF")
+		description.remove_prefix(3);
+
+	Alphabet alphabet = none();
+	bool identity = true;
+	while (!description.empty()) {
+		size_t end = description.find('\n');
+		std::string_view line = description.substr(0, end);
+		description.remove_prefix(end == std::string_view::npos
+			? description.length() : end + 1);
+
+		std::vector<std::string_view> fields = split(line);
+		if (!fields.empty() && fields.back().back() == '\r') {
+			fields.back().remove_suffix(1);
+			if (fields.back().empty())
+				fields.pop_back();
+		}
+
+		if (fields.empty() || fields.front().front() == '#')
+			continue;
+		if (fields.size() < 2 || alphabet.count == MaxTiles)
+			return none();
+
+		std::string_view points = fields.back();
+		unsigned value = 0;
+		auto parsed = std::from_chars(points.data(),
+			points.data() + points.length(), value);
+		if (parsed.ec != std::errc() || parsed.ptr != points.data()
+			+ points.length() || value == 0 || value > UINT8_MAX)
+			return none();
+
+		uint8_t tile = static_cast<uint8_t>(alphabet.count++);
+		alphabet.values[tile] = static_cast<uint8_t>(value);
+		for (size_t i = 0; i + 1 < fields.size(); ++i) {
+			std::string_view spelling = fields[i];
+			for (char character : spelling) {
+				if (!isLetter(character)
+					&& static_cast<unsigned char>(character) < 0x80)
+					return none();
+			}
+
+			for (Form const& form : alphabet.forms) {
+				if (form.text.length() == spelling.length()
+					&& startsWith(form.text, spelling))
+					return none();
+			}
+
+			identity = identity && spelling.length() == 1
+				&& upper(spelling.front()) == codeOf(tile);
+			alphabet.forms.push_back({ std::string(spelling), tile });
+		}
+	}
+
+	alphabet.identity = identity && alphabet.count == 26;
+	return alphabet;
+}
+
+/**
+ * Writes the description of the alphabet
+ *
+ * @return text that parse() reads back into the same alphabet
+ */
+std::string Alphabet::describe() const {
+	std::string description;
+	for (size_t tile = 0; tile < count; ++tile) {
+		for (Form const& form : forms) {
+			if (form.tile != tile)
+				continue;
+
+			description.append(form.text);
+			description.push_back(' ');
+		}
+
+		char digits[4] = {};
+		char* end = std::to_chars(digits, digits + sizeof(digits),
+			values[tile]).ptr;
+		description.append(digits, end);
+		description.push_back('\n');
+	}
+
+	return description;
+}
+
+/**
+ * @param tile is the position of a tile
+ * @return spelling the tile is shown with
+ */
+std::string_view Alphabet::spelling(_In_ size_t tile) const {
+	for (Form const& form : forms) {
+		if (form.tile == tile)
+			return form.text;
+	}
+
+	return {};
+}
+
+/**
+ * Maps text onto tile codes
+ *
+ * At every point, the longest spelling that the text goes on with is taken.
+ * Characters that are not letters are kept as they are, so the blanks of a
+ * rack and the syntax of a pattern carry over, while a letter that no tile
+ * spells becomes a character that nothing matches.
+ *
+ * @param text is the text to map, in UTF-8
+ * @return tile codes of the text
+ */
+std::string Alphabet::encode(_In_ std::string_view text) const {
+	if (identity)
+		return std::string(text);
+
+	std::string codes;
+	codes.reserve(text.length());
+	for (size_t i = 0; i < text.length();) {
+		size_t length = 0;
+		size_t tile = match(text.substr(i), length);
+		if (length) {
+			codes.push_back(codeOf(tile));
+			i += length;
+		} else if (!isLetter(text[i])
+			&& static_cast<unsigned char>(text[i]) < 0x80) {
+			codes.push_back(text[i]);
+			++i;
+		} else {
+			codes.push_back(Unknown);
+			i += std::min(sequenceLength(text[i]), text.length() - i);
+		}
+	}
+
+	return codes;
+}
+
+/**
+ * Maps tile codes back onto text
+ *
+ * @param codes are the tile codes to map
+ * @return text of the tiles, in UTF-8
+ */
+std::string Alphabet::decode(_In_ std::string_view codes) const {
+	if (identity)
+		return std::string(codes);
+
+	std::string text;
+	text.reserve(codes.length());
+	for (char code : codes) {
+		int tile = tileOf(code);
+		if (tile >= 0 && static_cast<size_t>(tile) < count)
+			text.append(spelling(static_cast<size_t>(tile)));
+		else
+			text.push_back(code);
+	}
+
+	return text;
+}
+
+/**
+ * Maps every word of a word list onto tile codes
+ *
+ * The classic alphabet keeps the word list as it is, viewing the same text.
+ *
+ * @param words is the word list, in UTF-8
+ * @return word list of tile codes that owns its text, without the words that
+ *         cannot be spelled with the tiles
+ */
+Dictionary Alphabet::transcode(_In_ Dictionary const& words) const {
+	if (identity)
+		return words;
+
+	auto text = std::make_shared<std::string>();
+	for (size_t i = 0; i < words.size(); ++i) {
+		std::string codes = encode(words[i]);
+		if (codes.find(Unknown) != std::string::npos)
+			continue;
+
+		text->append(codes);
+		text->push_back('\n');
+	}
+
+	char const* data = text->data();
+	size_t size = text->size();
+	return Dictionary(data, size, std::move(text));
+}
+
+/**
+ * Finds the longest spelling that some text starts with
+ *
+ * @param text is the text to match
+ * @param length receives the length of the spelling, or zero if none fits
+ * @return position of the tile with the spelling
+ */
+size_t Alphabet::match(_In_ std::string_view text,
+	_Out_ size_t& length) const {
+	size_t tile = 0;
+	length = 0;
+	for (Form const& form : forms) {
+		if (form.text.length() > length && startsWith(text, form.text)) {
+			length = form.text.length();
+			tile = form.tile;
+		}
+	}
+
+	return tile;
+}
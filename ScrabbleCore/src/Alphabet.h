@@ -0,0 +1,202 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Tiles of a language and the mapping from text onto them
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sal.h>
+
+#include "Dictionary.h"
+
+/**
+ * Builds the table that turns a tile code back into the tile's position
+ *
+ * @return position of the tile each character stands for, or -1 for a
+ *         character that is not a tile code
+ */
+constexpr std::array<int8_t, 256> makeTileTable() {
+	std::array<int8_t, 256> table = {};
+	for (int8_t& entry : table)
+		entry = -1;
+	for (int i = 0; i < 26; ++i) {
+		table['A' + i] = static_cast<int8_t>(i);
+		table['a' + i] = static_cast<int8_t>(i);
+	}
+	for (int i = 26; i < 32; ++i)
+		table[0x80 + i - 26] = static_cast<int8_t>(i);
+
+	return table;
+}
+
+/**
+ * Converts a lowercase letter to uppercase
+ *
+ * @param letter is the character to convert
+ * @return uppercase letter, or the character unchanged if it is not a
+ *         lowercase letter
+ */
+constexpr char upper(_In_ char letter) {
+	if (letter >= 'a' && letter <= 'z')
+		return static_cast<char>(letter - 'a' + 'A');
+	return letter;
+}
+
+/**
+ * Tiles that words are spelled with, and how text maps onto them
+ *
+ * The indexes store words as tile codes rather than as text. The first 26
+ * codes are the letters A to Z, matched regardless of case, and any further
+ * tiles are the bytes from 0x80 up, so codes sort in the order that the
+ * tiles are listed in. A tile can be spelled with more than one character,
+ * such as CH, or with a character outside of ASCII, such as Ñ. Text is
+ * mapped onto tiles only once, when a word list is indexed or a query is
+ * read, and the results are mapped back when they are shown.
+ *
+ * The classic alphabet spells every tile with its own letter, so its text
+ * already is made of tile codes and never needs to be mapped at all.
+ */
+class Alphabet {
+public:
+	/**
+	 * Largest number of tiles, which is the width of a letter count record
+	 */
+	static constexpr size_t MaxTiles = 32;
+
+	/**
+	 * Builds the classic alphabet of the letters A to Z, with the point
+	 * values of the standard tile set
+	 */
+	Alphabet();
+
+	/**
+	 * Reads an alphabet from its description
+	 *
+	 * Each line describes the next tile: its spellings, separated by
+	 * spaces, followed by its point value. The first spelling is the one it
+	 * is shown with. ASCII letters match either case, while any other
+	 * character only matches as written, so the lowercase forms of accented
+	 * letters are listed as spellings of their own. Blank lines and lines
+	 * starting with # are skipped.
+	 *
+	 * @param description is the text of the description, in UTF-8
+	 * @return alphabet, or an empty alphabet if a line is malformed, a
+	 *         spelling holds a character that is not a letter or is given
+	 *         twice, a tile is worth no points or there are more than
+	 *         MaxTiles tiles
+	 */
+	static Alphabet parse(_In_ std::string_view description);
+
+	/**
+	 * Writes the description of the alphabet
+	 *
+	 * @return text that parse() reads back into the same alphabet
+	 */
+	std::string describe() const;
+
+	/**
+	 * @return true if the alphabet has no tiles, which means it could not
+	 *         be read
+	 */
+	bool empty() const {
+		return !count;
+	}
+
+	/**
+	 * @return number of tiles
+	 */
+	size_t size() const {
+		return count;
+	}
+
+	/**
+	 * @return true if the tiles are the letters A to Z in order, so text is
+	 *         used as it is instead of being mapped
+	 */
+	bool classic() const {
+		return identity;
+	}
+
+	/**
+	 * @param tile is the position of a tile
+	 * @return point value of the tile
+	 */
+	uint8_t value(_In_ size_t tile) const {
+		return values[tile];
+	}
+
+	/**
+	 * @param tile is the position of a tile
+	 * @return spelling the tile is shown with
+	 */
+	std::string_view spelling(_In_ size_t tile) const;
+
+	/**
+	 * Maps text onto tile codes
+	 *
+	 * @param text is the text to map, in UTF-8
+	 * @return tile codes of the text
+	 */
+	std::string encode(_In_ std::string_view text) const;
+
+	/**
+	 * Maps tile codes back onto text
+	 *
+	 * @param codes are the tile codes to map
+	 * @return text of the tiles, in UTF-8
+	 */
+	std::string decode(_In_ std::string_view codes) const;
+
+	/**
+	 * Maps every word of a word list onto tile codes
+	 *
+	 * @param words is the word list, in UTF-8
+	 * @return word list of tile codes that owns its text, without the words
+	 *         that cannot be spelled with the tiles
+	 */
+	Dictionary transcode(_In_ Dictionary const& words) const;
+
+	/**
+	 * @param code is a character of a word or query
+	 * @return position of the tile the character stands for, or -1 if it
+	 *         is not a tile code
+	 */
+	static int tileOf(_In_ char code) {
+		return Codes[static_cast<unsigned char>(code)];
+	}
+
+	/**
+	 * @param tile is the position of a tile
+	 * @return tile code of the tile
+	 */
+	static char codeOf(_In_ size_t tile) {
+		return static_cast<char>(tile < 26 ? 'A' + tile : 0x80 + tile - 26);
+	}
+
+private:
+	/**
+	 * One way of spelling a tile
+	 */
+	struct Form {
+		std::string text;
+		uint8_t tile;
+	};
+
+	static constexpr std::array<int8_t, 256> Codes = makeTileTable();
+
+	size_t match(_In_ std::string_view text, _Out_ size_t& length) const;
+
+	std::vector<Form> forms;
+	std::array<uint8_t, MaxTiles> values = {};
+	size_t count = 0;
+	bool identity = false;
+};
@@ -0,0 +1,92 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Monotonic scratch memory that is reused from one query to the next
+ */
+
+#include "Arena.h"
+
+#include <algorithm>
+
+namespace {
+	/**
+	 * Smallest block taken from the heap, so small allocations do not each
+	 * need a block of their own
+	 */
+	constexpr size_t MinimumBlock = 64 * 1024;
+}
+
+/**
+ * @param capacity is the size in bytes of the first block, or zero to wait
+ *        for the first allocation
+ */
+Arena::Arena(_In_ size_t capacity) {
+	if (capacity)
+		grow(capacity);
+}
+
+/**
+ * Hands out uninitialized memory
+ *
+ * The memory comes from the end of the current block. If it does not fit, a
+ * new block at least twice the size of the last one is taken, so a round
+ * only ever needs a few blocks.
+ *
+ * @param size is the number of bytes needed
+ * @param alignment is the alignment needed, which must be a power of two
+ * @return start of the memory, which stays valid until the next reset
+ */
+void* Arena::allocate(_In_ size_t size, _In_ size_t alignment) {
+	if (!blocks.empty()) {
+		Block& block = blocks.back();
+		uintptr_t base = reinterpret_cast<uintptr_t>(block.memory.get());
+		uintptr_t start = (base + offset + alignment - 1) & ~(alignment - 1);
+		if (start + size <= base + block.size) {
+			offset = start + size - base;
+			return reinterpret_cast<void*>(start);
+		}
+	}
+
+	size_t last = blocks.empty() ? 0 : blocks.back().size;
+	grow(std::max({ size + alignment, last * 2, MinimumBlock }));
+	return allocate(size, alignment);
+}
+
+/**
+ * Makes all of the memory available again
+ *
+ * If more than one block was needed, they are merged into one, so the same
+ * amount of memory fits in a single block next time.
+ */
+void Arena::reset() {
+	offset = 0;
+	if (blocks.size() <= 1)
+		return;
+
+	size_t total = capacity();
+	blocks.clear();
+	grow(total);
+}
+
+/**
+ * @return number of bytes held from the heap
+ */
+size_t Arena::capacity() const {
+	size_t total = 0;
+	for (Block const& block : blocks)
+		total += block.size;
+
+	return total;
+}
+
+/**
+ * Takes a new block from the heap and makes it the current one
+ *
+ * @param size is the size of the block in bytes
+ */
+void Arena::grow(_In_ size_t size) {
+	blocks.push_back({ std::unique_ptr<char[]>(new char[size]), size });
+	offset = 0;
+	++blocksTaken;
+}
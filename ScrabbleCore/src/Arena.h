@@ -0,0 +1,99 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Monotonic scratch memory that is reused from one query to the next
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <sal.h>
+
+/**
+ * Bump allocator for memory that only lives until the next reset
+ *
+ * Memory is handed out from the end of the current block and is never freed
+ * on its own. Resetting rewinds to the start without giving any memory back,
+ * and if the last round needed more than one block, they are replaced by a
+ * single block big enough for all of them. After the first few rounds, every
+ * allocation is served from memory that is already held, so a steady stream
+ * of similar queries makes no calls to the heap at all.
+ */
+class Arena {
+public:
+	/**
+	 * @param capacity is the size in bytes of the first block, or zero to
+	 *        wait for the first allocation
+	 */
+	explicit Arena(_In_ size_t capacity = 0);
+
+	Arena(Arena const&) = delete;
+	Arena& operator=(Arena const&) = delete;
+	Arena(Arena&&) = default;
+	Arena& operator=(Arena&&) = default;
+
+	/**
+	 * Hands out uninitialized memory
+	 *
+	 * @param size is the number of bytes needed
+	 * @param alignment is the alignment needed, which must be a power of two
+	 * @return start of the memory, which stays valid until the next reset
+	 */
+	void* allocate(_In_ size_t size, _In_ size_t alignment);
+
+	/**
+	 * Hands out uninitialized memory for an array
+	 *
+	 * Only types that need no destructor may be stored, since the arena never
+	 * runs any.
+	 *
+	 * @param count is the number of elements needed
+	 * @return first element, which stays valid until the next reset
+	 */
+	template<typename T>
+	T* allocate(_In_ size_t count) {
+		static_assert(std::is_trivially_destructible_v<T>,
+			"arena memory is never destroyed");
+		return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+	}
+
+	/**
+	 * Makes all of the memory available again
+	 *
+	 * Everything handed out before the reset must no longer be used.
+	 */
+	void reset();
+
+	/**
+	 * @return number of bytes held from the heap
+	 */
+	size_t capacity() const;
+
+	/**
+	 * @return number of blocks taken from the heap since the arena was made
+	 */
+	size_t refills() const {
+		return blocksTaken;
+	}
+
+private:
+	/**
+	 * Memory taken from the heap in one piece
+	 */
+	struct Block {
+		std::unique_ptr<char[]> memory;
+		size_t size;
+	};
+
+	void grow(_In_ size_t size);
+
+	std::vector<Block> blocks;
+	size_t offset = 0;
+	size_t blocksTaken = 0;
+};
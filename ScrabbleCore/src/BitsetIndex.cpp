@@ -0,0 +1,423 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Compressed bitsets of the words with each letter count and tile count
+ */
+
+#include "BitsetIndex.h"
+
+#include <algorithm>
+#include <string_view>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "Rack.h"
+
+namespace {
+	/**
+	 * @param bits is a nonzero word of a bitmap
+	 * @return position of its lowest set bit
+	 */
+	unsigned lowestBit(_In_ uint64_t bits) {
+#if defined(_MSC_VER) && defined(_WIN64)
+		unsigned long index = 0;
+		_BitScanForward64(&index, bits);
+		return index;
+#elif defined(_MSC_VER)
+		unsigned long index = 0;
+		if (_BitScanForward(&index, static_cast<unsigned long>(bits)))
+			return index;
+		_BitScanForward(&index, static_cast<unsigned long>(bits >> 32));
+		return index + 32;
+#else
+		return static_cast<unsigned>(__builtin_ctzll(bits));
+#endif
+	}
+
+	/**
+	 * Sets the bits of a bitmap at every value of a sorted array
+	 *
+	 * @param bits is the bitmap
+	 * @param values are the positions of the bits to set
+	 * @param count is the number of values
+	 */
+	void scatter(_Inout_ uint64_t* bits, _In_reads_(count)
+		uint16_t const* values, _In_ size_t count) {
+		for (size_t i = 0; i < count; ++i)
+			bits[values[i] >> 6] |= uint64_t(1) << (values[i] & 63);
+	}
+
+	/**
+	 * Clears the bits of a bitmap at every value of a sorted array
+	 *
+	 * @param bits is the bitmap
+	 * @param values are the positions of the bits to clear
+	 * @param count is the number of values
+	 */
+	void unscatter(_Inout_ uint64_t* bits, _In_reads_(count)
+		uint16_t const* values, _In_ size_t count) {
+		for (size_t i = 0; i < count; ++i)
+			bits[values[i] >> 6] &= ~(uint64_t(1) << (values[i] & 63));
+	}
+
+	/**
+	 * Keeps only the bits that are also set in another bitmap
+	 *
+	 * The loop has no dependencies between words, so the compiler turns it
+	 * into vector instructions.
+	 *
+	 * @param bits is the bitmap to narrow
+	 * @param other is the bitmap to intersect with
+	 * @param words is the number of words in each bitmap
+	 */
+	void intersect(_Inout_updates_(words) uint64_t* bits,
+		_In_reads_(words) uint64_t const* other, _In_ size_t words) {
+		for (size_t i = 0; i < words; ++i)
+			bits[i] &= other[i];
+	}
+
+	/**
+	 * Clears the bits that are set in another bitmap
+	 *
+	 * @param bits is the bitmap to narrow
+	 * @param other is the bitmap to subtract
+	 * @param words is the number of words in each bitmap
+	 */
+	void subtract(_Inout_updates_(words) uint64_t* bits,
+		_In_reads_(words) uint64_t const* other, _In_ size_t words) {
+		for (size_t i = 0; i < words; ++i)
+			bits[i] &= ~other[i];
+	}
+
+	/**
+	 * Counts the letters of a string
+	 *
+	 * @param text is the string to count
+	 * @param counts receives the count of each tile, with A at zero
+	 * @return number of letters in the string
+	 */
+	size_t countLetters(_In_ std::string_view text,
+		_Out_writes_(Alphabet::MaxTiles) size_t* counts) {
+		std::fill(counts, counts + Alphabet::MaxTiles, size_t(0));
+		size_t letters = 0;
+		for (char character : text) {
+			int tile = Alphabet::tileOf(character);
+			if (tile >= 0) {
+				++counts[tile];
+				++letters;
+			}
+		}
+
+		return letters;
+	}
+}
+
+/**
+ * Builds the lists for every word of a letter count index
+ *
+ * The positions of each chunk are gathered into one array per list first,
+ * then every array is stored as it is or turned into a bitmap, whichever is
+ * smaller.
+ *
+ * @param index is the letter count index to build from
+ */
+BitsetIndex::BitsetIndex(_In_ WordIndex const& index) : words(index.size()) {
+	size_t chunkCount = chunks();
+	std::vector<Container> built(ListCount * chunkCount);
+	std::vector<uint64_t> bitmapData;
+	std::vector<uint16_t> arrayData;
+	std::vector<std::vector<uint16_t>> members(ListCount);
+	for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+		for (std::vector<uint16_t>& list : members)
+			list.clear();
+
+		size_t base = chunk * ChunkSize;
+		size_t end = std::min(base + ChunkSize, words);
+		for (size_t position = base; position < end; ++position) {
+			uint8_t const* counts = index.counts(position);
+			uint16_t low = static_cast<uint16_t>(position - base);
+			size_t tiles = 0;
+			for (size_t letter = 0; letter < WordIndex::Stride; ++letter) {
+				tiles += counts[letter];
+				for (size_t count = 1; count <= counts[letter]
+					&& count <= MaxCount; ++count)
+					members[letterList(letter, count)].push_back(low);
+			}
+
+			for (size_t count = 1; count <= tiles && count <= MaxTiles; ++count)
+				members[tileList(count)].push_back(low);
+		}
+
+		for (size_t list = 0; list < ListCount; ++list) {
+			std::vector<uint16_t> const& values = members[list];
+			Container& container = built[list * chunkCount + chunk];
+			container.cardinality = static_cast<uint32_t>(values.size());
+			if (values.size() > ArrayLimit) {
+				container.offset = static_cast<uint32_t>(bitmapData.size());
+				bitmapData.resize(bitmapData.size() + BitmapWords);
+				scatter(bitmapData.data() + container.offset, values.data(),
+					values.size());
+			} else {
+				container.offset = static_cast<uint32_t>(arrayData.size());
+				arrayData.insert(arrayData.end(), values.begin(), values.end());
+			}
+		}
+	}
+
+	containers = Table<Container>(std::move(built));
+	bitmaps = Table<uint64_t>(std::move(bitmapData));
+	arrays = Table<uint16_t>(std::move(arrayData));
+}
+
+/**
+ * Estimates the number of candidates a query would produce
+ *
+ * The lists are taken to be independent. They are not, since words with
+ * more tiles tend to hold more of every letter, but the guess is close
+ * enough to pick an engine by.
+ *
+ * @param query contains the letters and filters
+ * @return expected number of candidates
+ */
+size_t BitsetIndex::estimate(_In_ Query const& query) const {
+	Plan terms = plan(query);
+	if (terms.impossible || !words)
+		return 0;
+
+	double total = static_cast<double>(words);
+	double expected = total;
+	for (size_t i = 0; i < terms.requiredCount; ++i)
+		expected *= terms.required[i].cardinality / total;
+	for (size_t i = 0; i < terms.excludedCount; ++i)
+		expected *= 1 - terms.excluded[i].cardinality / total;
+	return static_cast<size_t>(expected);
+}
+
+/**
+ * Finds the words that may be made from a query's rack and pass its filters
+ *
+ * Each chunk is solved on its own. When the most selective list holds so
+ * few positions in the chunk that looking each of them up in every other
+ * list costs less than one pass over a bitmap, that is what is done.
+ * Otherwise, the chunk's bitmap is built from it and narrowed by every
+ * other list in turn, most selective first, and the candidates are read off
+ * the bits that are left.
+ *
+ * @param query contains the letters and filters
+ * @param candidates receives the positions of the candidate words in
+ *        ascending order
+ */
+void BitsetIndex::find(_In_ Query const& query,
+	_Inout_ std::vector<uint32_t>& candidates) const {
+	Plan terms = plan(query);
+	if (terms.impossible || !words)
+		return;
+
+	size_t total = terms.requiredCount + terms.excludedCount;
+	uint64_t bits[BitmapWords];
+	uint64_t scratch[BitmapWords];
+	for (size_t chunk = 0; chunk < chunks(); ++chunk) {
+		if (isCancelled(query))
+			return;
+
+		size_t base = chunk * ChunkSize;
+		size_t size = std::min(ChunkSize, words - base);
+		if (terms.requiredCount) {
+			Container const& first = container(terms.required[0].list, chunk);
+			if (first.cardinality * total < BitmapWords) {
+				uint16_t const* values = arrays.data() + first.offset;
+				for (size_t i = 0; i < first.cardinality; ++i) {
+					bool kept = true;
+					for (size_t j = 1; j < terms.requiredCount && kept; ++j)
+						kept = contains(container(terms.required[j].list,
+							chunk), values[i]);
+					for (size_t j = 0; j < terms.excludedCount && kept; ++j)
+						kept = !contains(container(terms.excluded[j].list,
+							chunk), values[i]);
+
+					if (kept && base + values[i] < words)
+						candidates.push_back(
+							static_cast<uint32_t>(base + values[i]));
+				}
+
+				continue;
+			}
+
+			std::fill(bits, bits + BitmapWords, uint64_t(0));
+			if (first.cardinality > ArrayLimit)
+				std::copy_n(bitmaps.data() + first.offset, BitmapWords, bits);
+			else
+				scatter(bits, arrays.data() + first.offset, first.cardinality);
+		} else {
+			std::fill(bits, bits + BitmapWords, uint64_t(0));
+			std::fill(bits, bits + size / 64, ~uint64_t(0));
+			if (size % 64)
+				bits[size / 64] = (uint64_t(1) << (size % 64)) - 1;
+		}
+
+		for (size_t i = 1; i < terms.requiredCount; ++i) {
+			Container const& next = container(terms.required[i].list, chunk);
+			if (next.cardinality > ArrayLimit) {
+				intersect(bits, bitmaps.data() + next.offset, BitmapWords);
+			} else {
+				std::fill(scratch, scratch + BitmapWords, uint64_t(0));
+				scatter(scratch, arrays.data() + next.offset,
+					next.cardinality);
+				intersect(bits, scratch, BitmapWords);
+			}
+		}
+
+		for (size_t i = 0; i < terms.excludedCount; ++i) {
+			Container const& next = container(terms.excluded[i].list, chunk);
+			if (next.cardinality > ArrayLimit)
+				subtract(bits, bitmaps.data() + next.offset, BitmapWords);
+			else
+				unscatter(bits, arrays.data() + next.offset,
+					next.cardinality);
+		}
+
+		for (size_t word = 0; word < BitmapWords; ++word) {
+			for (uint64_t remaining = bits[word]; remaining;
+				remaining &= remaining - 1) {
+				size_t position = base + word * 64 + lowestBit(remaining);
+				if (position >= words)
+					break;
+				candidates.push_back(static_cast<uint32_t>(position));
+			}
+		}
+	}
+}
+
+/**
+ * @param list is the list
+ * @return number of words in the list
+ */
+uint32_t BitsetIndex::cardinality(_In_ uint32_t list) const {
+	uint32_t total = 0;
+	for (size_t chunk = 0; chunk < chunks(); ++chunk)
+		total += container(list, chunk).cardinality;
+
+	return total;
+}
+
+/**
+ * Turns a query into the lists its words must and must not be in
+ *
+ * A word must hold as many of each letter as any one filter does, and at
+ * least as many tiles as the longest filter. It cannot hold more of a
+ * letter than the rack has of it plus its blanks, nor need more tiles than
+ * the rack holds. Lists the words must be in are ordered from the smallest
+ * up, and lists they must not be in from the largest down, so the set
+ * shrinks as fast as possible. An empty list excludes nothing and is left
+ * out, which drops the tiles that no word holds.
+ *
+ * @param query contains the letters and filters
+ * @return lists to combine, or a plan marked impossible if no word can pass
+ */
+BitsetIndex::Plan BitsetIndex::plan(_In_ Query const& query) const {
+	Plan result = {};
+	Rack rack = makeRack(query.letters);
+
+	size_t needed[Alphabet::MaxTiles] = {};
+	size_t longest = 0;
+	for (std::string_view filter : { query.startsWith, query.endsWith,
+		query.contains }) {
+		size_t counts[Alphabet::MaxTiles] = {};
+		longest = std::max(longest, countLetters(filter, counts));
+		for (size_t letter = 0; letter < Alphabet::MaxTiles; ++letter)
+			needed[letter] = std::max(needed[letter], counts[letter]);
+	}
+
+	size_t blanks = static_cast<size_t>(std::max(rack.blanks, 0));
+	size_t held = blanks;
+	for (size_t letter = 0; letter < Alphabet::MaxTiles; ++letter) {
+		size_t available = rack.counts[letter] + blanks;
+		held += rack.counts[letter];
+		if (needed[letter] > available) {
+			result.impossible = true;
+			return result;
+		}
+
+		if (needed[letter]) {
+			uint32_t list =
+				letterList(letter, std::min(needed[letter], MaxCount));
+			result.required[result.requiredCount++] =
+				{ list, cardinality(list) };
+		}
+
+		if (available < MaxCount) {
+			uint32_t list = letterList(letter, available + 1);
+			uint32_t size = cardinality(list);
+			if (size)
+				result.excluded[result.excludedCount++] = { list, size };
+		}
+	}
+
+	if (longest > held) {
+		result.impossible = true;
+		return result;
+	}
+
+	if (longest > 1) {
+		uint32_t list = tileList(std::min(longest, MaxTiles));
+		result.required[result.requiredCount++] = { list, cardinality(list) };
+	}
+
+	if (held < MaxTiles) {
+		uint32_t list = tileList(held + 1);
+		result.excluded[result.excludedCount++] = { list, cardinality(list) };
+	}
+
+	std::sort(result.required, result.required + result.requiredCount,
+		[](_In_ Term const& a, _In_ Term const& b) {
+			return a.cardinality < b.cardinality;
+		});
+	std::sort(result.excluded, result.excluded + result.excludedCount,
+		[](_In_ Term const& a, _In_ Term const& b) {
+			return a.cardinality > b.cardinality;
+		});
+	return result;
+}
+
+/**
+ * @param container is the container to search
+ * @param value is the low 16 bits of a position in the container's chunk
+ * @return true if the position is in the container
+ */
+bool BitsetIndex::contains(_In_ Container const& container,
+	_In_ uint32_t value) const {
+	if (container.cardinality > ArrayLimit)
+		return (bitmaps[container.offset + (value >> 6)] >> (value & 63)) & 1;
+
+	uint16_t const* first = arrays.data() + container.offset;
+	return std::binary_search(first, first + container.cardinality,
+		static_cast<uint16_t>(value));
+}
+
+/**
+ * Checks that every container lies within the bitmaps and arrays, for
+ * lists viewed from a lexicon image
+ *
+ * @return true if the containers can be read safely
+ */
+bool BitsetIndex::intact() const {
+	if (containers.size() != ListCount * chunks())
+		return false;
+
+	for (Container const& container : containers) {
+		if (container.cardinality > ChunkSize)
+			return false;
+		if (container.cardinality > ArrayLimit) {
+			if (bitmaps.size() < BitmapWords
+				|| container.offset > bitmaps.size() - BitmapWords)
+				return false;
+		} else if (container.offset > arrays.size()
+			|| container.cardinality > arrays.size() - container.offset)
+			return false;
+	}
+
+	return true;
+}
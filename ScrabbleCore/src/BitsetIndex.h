@@ -0,0 +1,162 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Compressed bitsets of the words with each letter count and tile count
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <sal.h>
+
+#include "Query.h"
+#include "Table.h"
+#include "WordIndex.h"
+
+/**
+ * Posting lists over word positions that are combined with set operations
+ *
+ * There is one list for every tile and count, holding the words with at
+ * least that many of the tile, and one for every number of tiles, holding
+ * the words that need at least that many tiles. A query is turned into the
+ * lists its words must be in and the lists they must not be in: a word
+ * cannot need more of a letter than the rack and its blanks can cover, nor
+ * more tiles than the rack holds, and it must hold every letter of the
+ * filters. The result only narrows the search, so every candidate still has
+ * to be checked against the rack and filters themselves.
+ *
+ * Like a roaring bitmap, positions are split into chunks of 65536 and every
+ * list keeps one container per chunk, which is a sorted array of the low 16
+ * bits of its positions when it has few of them and a bitmap otherwise.
+ */
+class BitsetIndex {
+public:
+	/**
+	 * Highest letter count with its own list, so a word with more of a
+	 * letter is only in the lists up to this count
+	 */
+	static constexpr size_t MaxCount = 4;
+
+	/**
+	 * Highest tile count with its own list
+	 */
+	static constexpr size_t MaxTiles = 32;
+
+	BitsetIndex() = default;
+
+	/**
+	 * Builds the lists for every word of a letter count index
+	 *
+	 * @param index is the letter count index to build from
+	 */
+	explicit BitsetIndex(_In_ WordIndex const& index);
+
+	/**
+	 * Estimates the number of candidates a query would produce
+	 *
+	 * @param query contains the letters and filters
+	 * @return expected number of candidates, taking the lists to be
+	 *         independent
+	 */
+	size_t estimate(_In_ Query const& query) const;
+
+	/**
+	 * Finds the words that may be made from a query's rack and pass its
+	 * filters
+	 *
+	 * @param query contains the letters and filters
+	 * @param candidates receives the positions of the candidate words in
+	 *        ascending order
+	 */
+	void find(_In_ Query const& query,
+		_Inout_ std::vector<uint32_t>& candidates) const;
+
+private:
+	friend class LexiconImage;
+
+	/**
+	 * Positions of one list within one chunk
+	 *
+	 * A container holding more than ArrayLimit positions is a bitmap
+	 * starting at the offset in the bitmaps, and any other is an array
+	 * starting at the offset in the arrays.
+	 */
+	struct Container {
+		uint32_t offset;
+		uint32_t cardinality;
+	};
+
+	/**
+	 * List a plan combines, with the number of words in it
+	 */
+	struct Term {
+		uint32_t list;
+		uint32_t cardinality;
+	};
+
+	/**
+	 * Lists a query's words must and must not be in, most selective first
+	 */
+	struct Plan {
+		Term required[Alphabet::MaxTiles + 1];
+		Term excluded[Alphabet::MaxTiles + 1];
+		size_t requiredCount;
+		size_t excludedCount;
+		bool impossible;
+	};
+
+	static constexpr size_t ChunkBits = 16;
+	static constexpr size_t ChunkSize = size_t(1) << ChunkBits;
+	static constexpr size_t BitmapWords = ChunkSize / 64;
+	static constexpr size_t ArrayLimit = 4096;
+	static constexpr size_t ListCount =
+		Alphabet::MaxTiles * MaxCount + MaxTiles;
+
+	/**
+	 * @param letter is the position of the letter in the alphabet
+	 * @param count is the count, from one to MaxCount
+	 * @return list of the words with at least that many of the letter
+	 */
+	static uint32_t letterList(_In_ size_t letter, _In_ size_t count) {
+		return static_cast<uint32_t>(letter * MaxCount + count - 1);
+	}
+
+	/**
+	 * @param tiles is the tile count, from one to MaxTiles
+	 * @return list of the words that need at least that many tiles
+	 */
+	static uint32_t tileList(_In_ size_t tiles) {
+		return static_cast<uint32_t>(Alphabet::MaxTiles * MaxCount
+			+ tiles - 1);
+	}
+
+	/**
+	 * @return number of chunks the positions are split into
+	 */
+	size_t chunks() const {
+		return (words + ChunkSize - 1) / ChunkSize;
+	}
+
+	/**
+	 * @param list is the list
+	 * @param chunk is the chunk
+	 * @return container of the list for the chunk
+	 */
+	Container const& container(_In_ uint32_t list, _In_ size_t chunk) const {
+		return containers[list * chunks() + chunk];
+	}
+
+	uint32_t cardinality(_In_ uint32_t list) const;
+	Plan plan(_In_ Query const& query) const;
+	bool contains(_In_ Container const& container, _In_ uint32_t value) const;
+	bool intact() const;
+
+	Table<Container> containers;
+	Table<uint64_t> bitmaps;
+	Table<uint16_t> arrays;
+	size_t words = 0;
+};
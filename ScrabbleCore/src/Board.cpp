@@ -0,0 +1,240 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Playing board with premium squares and cached cross-checks
+ */
+
+#include "Board.h"
+
+#include <vector>
+
+#include "Alphabet.h"
+#include "Scoring.h"
+
+namespace {
+	/**
+	 * Cross-check of a square that no perpendicular word touches
+	 */
+	constexpr CrossCheck Open = { (1u << 26) - 1, 0, false };
+
+	/**
+	 * Bonus squares of the top half of the board, which is mirrored below
+	 *
+	 * T is a triple word, D a double word, t a triple letter and d a double
+	 * letter square.
+	 */
+	constexpr char Layout[Board::Center + 1][Board::Size + 1] = {
+		"T..d...T...d..T",
+		".D...t...t...D.",
+		"..D...d.d...D..",
+		"d..D...d...D..d",
+		"....D.....D....",
+		".t...t...t...t.",
+		"..d...d.d...d..",
+		"T..d...D...d..T"
+	};
+
+	/**
+	 * @param row is the row of the square
+	 * @param column is the column of the square
+	 * @return true if the square is on the board
+	 */
+	bool inside(_In_ int row, _In_ int column) {
+		return row >= 0 && row < Board::Size && column >= 0
+			&& column < Board::Size;
+	}
+}
+
+/**
+ * Creates an empty board
+ *
+ * @param dawg is the word graph words are checked against, which must
+ *        outlive the board
+ */
+Board::Board(_In_ Dawg const& dawg) : dawg(dawg) {
+	clear();
+}
+
+/**
+ * @param tile is the contents of a square
+ * @return points of the tile, which is zero for a blank or an empty square
+ */
+int Board::value(_In_ char tile) {
+	return TileScores<TileSet::Standard>[static_cast<unsigned char>(tile)];
+}
+
+/**
+ * @param row is the row of the square
+ * @param column is the column of the square
+ * @return bonus printed on the square
+ */
+Premium Board::premium(_In_ int row, _In_ int column) {
+	if (!inside(row, column))
+		return Premium::None;
+	if (row > Center)
+		row = Size - 1 - row;
+
+	switch (Layout[row][column]) {
+		case 'T':
+			return Premium::TripleWord;
+		case 'D':
+			return Premium::DoubleWord;
+		case 't':
+			return Premium::TripleLetter;
+		case 'd':
+			return Premium::DoubleLetter;
+		default:
+			return Premium::None;
+	}
+}
+
+/**
+ * Lays a move's new tiles on the board
+ *
+ * Every new tile can only change the squares at the two ends of the lines
+ * running through it, so those are the only cross-checks refreshed.
+ *
+ * @param move is the move to play
+ * @return false if the move runs off the board or disagrees with a tile
+ *         already on it, in which case the board is unchanged
+ */
+bool Board::play(_In_ Move const& move) {
+	int rowStep = move.direction == Direction::Down ? 1 : 0;
+	int columnStep = 1 - rowStep;
+	for (size_t i = 0; i < move.word.length(); ++i) {
+		int row = move.row + rowStep * static_cast<int>(i);
+		int column = move.column + columnStep * static_cast<int>(i);
+		char letter = upper(move.word[i]);
+		if (!inside(row, column) || letter < 'A' || letter > 'Z')
+			return false;
+
+		char tile = at(row, column);
+		if (tile && upper(tile) != letter)
+			return false;
+	}
+
+	std::vector<int> placed;
+	for (size_t i = 0; i < move.word.length(); ++i) {
+		int row = move.row + rowStep * static_cast<int>(i);
+		int column = move.column + columnStep * static_cast<int>(i);
+		char& tile = squares[row * Size + column];
+		if (!tile) {
+			tile = move.word[i];
+			placed.push_back(row * Size + column);
+			++tiles;
+		}
+	}
+
+	for (int square : placed) {
+		refreshEnds(Direction::Across, square / Size, square % Size);
+		refreshEnds(Direction::Down, square / Size, square % Size);
+	}
+
+	return true;
+}
+
+/**
+ * Removes every tile
+ */
+void Board::clear() {
+	squares.fill('\0');
+	checks[0].fill(Open);
+	checks[1].fill(Open);
+	tiles = 0;
+}
+
+/**
+ * Recomputes the cross-check of one empty square
+ *
+ * The tiles before and after the square along the perpendicular line are
+ * gathered, then the graph is walked down the tiles before it and every
+ * letter leaving that node is tried against the tiles after it.
+ *
+ * @param direction is the direction of the moves the check applies to
+ * @param row is the row of the square
+ * @param column is the column of the square
+ */
+void Board::refresh(_In_ Direction direction, _In_ int row,
+	_In_ int column) {
+	int rowStep = direction == Direction::Across ? 1 : 0;
+	int columnStep = 1 - rowStep;
+	CrossCheck& check =
+		checks[static_cast<size_t>(direction)][row * Size + column];
+
+	int before = 0;
+	for (int r = row - rowStep, c = column - columnStep;
+		inside(r, c) && at(r, c); r -= rowStep, c -= columnStep)
+		++before;
+
+	int after = 0;
+	for (int r = row + rowStep, c = column + columnStep;
+		inside(r, c) && at(r, c); r += rowStep, c += columnStep)
+		++after;
+
+	if (!before && !after) {
+		check = Open;
+		return;
+	}
+
+	check = { 0, 0, true };
+	uint32_t node = Dawg::Root;
+	for (int i = before; i > 0; --i) {
+		char tile = at(row - rowStep * i, column - columnStep * i);
+		check.points += value(tile);
+		if (node != Dawg::Missing)
+			node = dawg.follow(node, upper(tile));
+	}
+
+	std::string suffix;
+	for (int i = 1; i <= after; ++i) {
+		char tile = at(row + rowStep * i, column + columnStep * i);
+		check.points += value(tile);
+		suffix.push_back(upper(tile));
+	}
+
+	if (node == Dawg::Missing)
+		return;
+
+	Dawg::Node const& from = dawg.node(node);
+	for (uint32_t i = 0; i < from.edgeCount; ++i) {
+		Dawg::Edge const& edge = dawg.edge(from.firstEdge + i);
+		if (edge.letter < 'A' || edge.letter > 'Z')
+			continue;
+
+		uint32_t next = edge.target;
+		for (char letter : suffix) {
+			next = dawg.follow(next, letter);
+			if (next == Dawg::Missing)
+				break;
+		}
+
+		if (next != Dawg::Missing && dawg.node(next).terminal)
+			check.letters |= 1u << (edge.letter - 'A');
+	}
+}
+
+/**
+ * Refreshes the empty squares at both ends of the line through a tile
+ *
+ * @param direction is the direction of the moves whose checks change, so
+ *        the line runs the other way
+ * @param row is the row of the tile
+ * @param column is the column of the tile
+ */
+void Board::refreshEnds(_In_ Direction direction, _In_ int row,
+	_In_ int column) {
+	int rowStep = direction == Direction::Across ? 1 : 0;
+	int columnStep = 1 - rowStep;
+	for (int sign = -1; sign <= 1; sign += 2) {
+		int r = row;
+		int c = column;
+		while (inside(r, c) && at(r, c)) {
+			r += sign * rowStep;
+			c += sign * columnStep;
+		}
+
+		if (inside(r, c))
+			refresh(direction, r, c);
+	}
+}
@@ -0,0 +1,185 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Playing board with premium squares and cached cross-checks
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include <sal.h>
+
+#include "Dawg.h"
+
+/**
+ * Direction a word is laid out in on the board
+ */
+enum class Direction : uint8_t {
+	Across, Down
+};
+
+/**
+ * Bonus printed on a square of the board
+ */
+enum class Premium : uint8_t {
+	None, DoubleLetter, TripleLetter, DoubleWord, TripleWord
+};
+
+/**
+ * Word laid on the board
+ *
+ * The word holds every letter of the main word from its first square,
+ * including tiles that were already on the board. Letters played with a
+ * blank are lowercase.
+ */
+struct Move {
+	std::string word;
+	uint8_t row = 0;
+	uint8_t column = 0;
+	Direction direction = Direction::Across;
+	int score = 0;
+};
+
+/**
+ * Constraint that perpendicular words put on an empty square
+ */
+struct CrossCheck {
+	/**
+	 * Bit i is set if the letter 'A' + i can be placed on the square
+	 */
+	uint32_t letters;
+
+	/**
+	 * Points of the tiles of the perpendicular word already on the board
+	 */
+	int points;
+
+	/**
+	 * True if a perpendicular word touches the square, so placing a tile
+	 * also forms and scores that word
+	 */
+	bool linked;
+};
+
+/**
+ * Standard 15 by 15 board, tracking which letters each empty square accepts
+ *
+ * For every empty square and direction, the letters that complete a valid
+ * perpendicular word are cached along with the points of that word's tiles.
+ * Playing a move only refreshes the squares at the ends of the lines that
+ * its new tiles extend, as no other square's neighbours change. Squares hold
+ * '\0' when empty, an uppercase letter for a tile and a lowercase letter for
+ * a blank.
+ */
+class Board {
+public:
+	/**
+	 * Number of rows and columns
+	 */
+	static constexpr int Size = 15;
+
+	/**
+	 * Row and column of the square the first move must cover
+	 */
+	static constexpr int Center = 7;
+
+	/**
+	 * Number of tiles on a full rack, which earn a bonus when all are played
+	 */
+	static constexpr int RackSize = 7;
+
+	/**
+	 * Points awarded for playing a full rack in one move
+	 */
+	static constexpr int Bingo = 50;
+
+	/**
+	 * Creates an empty board
+	 *
+	 * @param dawg is the word graph words are checked against, which must
+	 *        outlive the board
+	 */
+	explicit Board(_In_ Dawg const& dawg);
+
+	/**
+	 * @return word graph words are checked against
+	 */
+	Dawg const& graph() const {
+		return dawg;
+	}
+
+	/**
+	 * @return true if no tile has been played yet
+	 */
+	bool empty() const {
+		return tiles == 0;
+	}
+
+	/**
+	 * @param row is the row of the square
+	 * @param column is the column of the square
+	 * @return contents of the square
+	 */
+	char at(_In_ int row, _In_ int column) const {
+		return squares[row * Size + column];
+	}
+
+	/**
+	 * @param tile is the contents of a square
+	 * @return points of the tile, which is zero for a blank or an empty
+	 *         square
+	 */
+	static int value(_In_ char tile);
+
+	/**
+	 * @param row is the row of the square
+	 * @param column is the column of the square
+	 * @return bonus printed on the square
+	 */
+	static Premium premium(_In_ int row, _In_ int column);
+
+	/**
+	 * Looks up the cached constraint of an empty square
+	 *
+	 * @param direction is the direction of the move being placed, so the
+	 *        constraint comes from the word running the other way
+	 * @param row is the row of the square
+	 * @param column is the column of the square
+	 * @return letters allowed on the square and their perpendicular word
+	 */
+	CrossCheck const& crossCheck(_In_ Direction direction, _In_ int row,
+		_In_ int column) const {
+		return checks[static_cast<size_t>(direction)][row * Size + column];
+	}
+
+	/**
+	 * Lays a move's new tiles on the board
+	 *
+	 * The words formed are not checked, so the move is expected to come from
+	 * the move generator.
+	 *
+	 * @param move is the move to play
+	 * @return false if the move runs off the board or disagrees with a tile
+	 *         already on it, in which case the board is unchanged
+	 */
+	bool play(_In_ Move const& move);
+
+	/**
+	 * Removes every tile
+	 */
+	void clear();
+
+private:
+	void refresh(_In_ Direction direction, _In_ int row, _In_ int column);
+	void refreshEnds(_In_ Direction direction, _In_ int row,
+		_In_ int column);
+
+	Dawg const& dawg;
+	std::array<char, Size * Size> squares;
+	std::array<CrossCheck, Size * Size> checks[2];
+	int tiles = 0;
+};
@@ -0,0 +1,435 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Directed acyclic word graph built from a dictionary
+ */
+
+#include "Dawg.h"
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Rack.h"
+#include "Solver.h"
+
+namespace {
+	/**
+	 * Compares two words while ignoring case
+	 *
+	 * @param first is the first word to compare
+	 * @param second is the second word to compare
+	 * @return negative, zero or positive like memcmp
+	 */
+	int compare(_In_ std::string_view first, _In_ std::string_view second) {
+		size_t length = std::min(first.length(), second.length());
+		for (size_t i = 0; i < length; ++i) {
+			unsigned char a = static_cast<unsigned char>(upper(first[i]));
+			unsigned char b = static_cast<unsigned char>(upper(second[i]));
+			if (a != b)
+				return a < b ? -1 : 1;
+		}
+
+		if (first.length() == second.length())
+			return 0;
+		return first.length() < second.length() ? -1 : 1;
+	}
+
+	/**
+	 * Node of the graph while it is being built
+	 */
+	struct State {
+		std::vector<Dawg::Edge> edges;
+		uint32_t words = 0;
+		bool terminal = false;
+	};
+}
+
+/**
+ * Builds the graph for every word in a dictionary
+ *
+ * The words are put in sorted order without duplicates first, and the
+ * dictionary position of each rank is stored if the two differ.
+ *
+ * @param dictionary is the word list to build the graph from
+ */
+Dawg::Dawg(_In_ Dictionary const& dictionary) {
+	std::vector<uint32_t> sorted(dictionary.size());
+	std::iota(sorted.begin(), sorted.end(), 0);
+
+	bool ordered = true;
+	for (size_t i = 1; i < dictionary.size() && ordered; ++i)
+		ordered = compare(dictionary[i - 1], dictionary[i]) < 0;
+
+	if (!ordered) {
+		std::stable_sort(sorted.begin(), sorted.end(), [&dictionary](
+			_In_ uint32_t a, _In_ uint32_t b) {
+				return compare(dictionary[a], dictionary[b]) < 0;
+			});
+		sorted.erase(std::unique(sorted.begin(), sorted.end(), [&dictionary](
+			_In_ uint32_t a, _In_ uint32_t b) {
+				return compare(dictionary[a], dictionary[b]) == 0;
+			}), sorted.end());
+		order = Table<uint32_t>(sorted);
+	}
+
+	std::vector<std::string_view> words(sorted.size());
+	for (size_t i = 0; i < sorted.size(); ++i)
+		words[i] = dictionary[sorted[i]];
+
+	build(words);
+}
+
+/**
+ * Builds the graph for a list of words
+ *
+ * @param words is the list of words to build the graph from, sorted while
+ *        ignoring case and without duplicates, so every rank is the word's
+ *        position in the list
+ */
+Dawg::Dawg(_In_ std::vector<std::string_view> const& words) {
+	build(words);
+}
+
+/**
+ * Adds a sorted list of words to an empty graph
+ *
+ * Whenever a word diverges from the one before it, the part of the previous
+ * word's path that can no longer change is minimized from the bottom up:
+ * each of its nodes is replaced by an equivalent node that was already
+ * registered, or is registered itself. Finally, the reachable nodes are laid
+ * out breadth first in flat arrays.
+ *
+ * @param words is the list of words, sorted while ignoring case and without
+ *        duplicates
+ */
+void Dawg::build(_In_ std::vector<std::string_view> const& words) {
+	std::vector<State> states(1);
+	std::vector<uint32_t> unused;
+	std::unordered_map<std::string, uint32_t> registry;
+	std::vector<uint32_t> path = { 0 };
+	std::string key;
+
+	auto minimize = [&](_In_ size_t depth) {
+		while (path.size() > depth + 1) {
+			uint32_t child = path.back();
+			path.pop_back();
+			State& state = states[child];
+
+			key.assign(1, state.terminal ? '\1' : '\0');
+			state.words = state.terminal ? 1 : 0;
+			for (Edge const& edge : state.edges) {
+				key.push_back(edge.letter);
+				key.append(reinterpret_cast<char const*>(&edge.target),
+					sizeof(edge.target));
+				state.words += states[edge.target].words;
+			}
+
+			auto found = registry.find(key);
+			if (found == registry.end()) {
+				registry.emplace(key, child);
+				continue;
+			}
+
+			states[path.back()].edges.back().target = found->second;
+			state = State();
+			unused.push_back(child);
+		}
+	};
+
+	std::string_view previous;
+	for (std::string_view word : words) {
+		if (word.empty())
+			continue;
+
+		size_t common = 0;
+		while (common < word.length() && common < previous.length()
+			&& upper(word[common]) == upper(previous[common]))
+			++common;
+
+		minimize(common);
+		for (size_t i = common; i < word.length(); ++i) {
+			uint32_t next = static_cast<uint32_t>(states.size());
+			if (unused.empty())
+				states.emplace_back();
+			else {
+				next = unused.back();
+				unused.pop_back();
+			}
+
+			states[path.back()].edges.push_back({ next, upper(word[i]) });
+			path.push_back(next);
+		}
+
+		states[path.back()].terminal = true;
+		previous = word;
+	}
+
+	minimize(0);
+	State& root = states[0];
+	root.words = root.terminal ? 1 : 0;
+	for (Edge const& edge : root.edges)
+		root.words += states[edge.target].words;
+
+	std::vector<uint32_t> renumbered(states.size(), UINT32_MAX);
+	std::vector<uint32_t> queue = { 0 };
+	renumbered[0] = 0;
+	for (size_t i = 0; i < queue.size(); ++i) {
+		for (Edge const& edge : states[queue[i]].edges) {
+			if (renumbered[edge.target] != UINT32_MAX)
+				continue;
+
+			renumbered[edge.target] = static_cast<uint32_t>(queue.size());
+			queue.push_back(edge.target);
+		}
+	}
+
+	std::vector<Node> flatNodes;
+	std::vector<Edge> flatEdges;
+	flatNodes.reserve(queue.size());
+	for (uint32_t old : queue) {
+		State const& state = states[old];
+		flatNodes.push_back({ static_cast<uint32_t>(flatEdges.size()),
+			state.words, static_cast<uint16_t>(state.edges.size()),
+			state.terminal });
+		for (Edge const& edge : state.edges)
+			flatEdges.push_back({ renumbered[edge.target], edge.letter });
+	}
+
+	nodes = Table<Node>(std::move(flatNodes));
+	edges = Table<Edge>(std::move(flatEdges));
+}
+
+/**
+ * Checks that the graph can be walked safely, for a graph viewed from a
+ * lexicon image
+ *
+ * The edges of every node must follow those of the node before it, and
+ * every edge must lead to a node. The nodes are then ordered so that every
+ * edge leads further down, which fails if there is a cycle, and the number
+ * of words under each node is recounted from the bottom up, so that the
+ * ranks of the words stay below the number of positions.
+ *
+ * @param words is the number of words in the dictionary
+ * @return true if the graph is a sound word graph of the dictionary
+ */
+bool Dawg::intact(_In_ size_t words) const {
+	size_t next = 0;
+	std::vector<uint32_t> incoming(nodes.size());
+	for (Node const& node : nodes) {
+		if (node.firstEdge != next || node.edgeCount > edges.size() - next)
+			return false;
+
+		next += node.edgeCount;
+		for (uint32_t i = 0; i < node.edgeCount; ++i) {
+			uint32_t target = edges[node.firstEdge + i].target;
+			if (target >= nodes.size())
+				return false;
+			++incoming[target];
+		}
+	}
+
+	if (next != edges.size())
+		return false;
+
+	std::vector<uint32_t> sorted;
+	sorted.reserve(nodes.size());
+	for (uint32_t node = 0; node < nodes.size(); ++node) {
+		if (!incoming[node])
+			sorted.push_back(node);
+	}
+
+	for (size_t i = 0; i < sorted.size(); ++i) {
+		Node const& current = nodes[sorted[i]];
+		for (uint32_t j = 0; j < current.edgeCount; ++j) {
+			uint32_t target = edges[current.firstEdge + j].target;
+			if (--incoming[target] == 0)
+				sorted.push_back(target);
+		}
+	}
+
+	if (sorted.size() != nodes.size())
+		return false;
+
+	for (size_t i = sorted.size(); i > 0; --i) {
+		Node const& current = nodes[sorted[i - 1]];
+		uint64_t below = current.terminal ? 1 : 0;
+		for (uint32_t j = 0; j < current.edgeCount; ++j)
+			below += nodes[edges[current.firstEdge + j].target].words;
+		if (below != current.words)
+			return false;
+	}
+
+	for (uint32_t position : order) {
+		if (position >= words)
+			return false;
+	}
+
+	return nodes.empty()
+		|| nodes[Root].words <= (order.empty() ? words : order.size());
+}
+
+/**
+ * Follows the edge for one letter out of a node
+ *
+ * Edges are few and sorted by letter, so they are scanned in order.
+ *
+ * @param from is the node to leave
+ * @param letter is the uppercase letter of the edge
+ * @return node the edge leads to, or Missing if there is no such edge
+ */
+uint32_t Dawg::follow(_In_ uint32_t from, _In_ char letter) const {
+	if (from >= nodes.size())
+		return Missing;
+
+	Node const& current = nodes[from];
+	for (uint32_t i = 0; i < current.edgeCount; ++i) {
+		Edge const& candidate = edges[current.firstEdge + i];
+		if (candidate.letter == letter)
+			return candidate.target;
+		if (static_cast<unsigned char>(candidate.letter)
+			> static_cast<unsigned char>(letter))
+			break;
+	}
+
+	return Missing;
+}
+
+/**
+ * Looks up the dictionary position of a word
+ *
+ * The word's rank is accumulated on the way down by counting the words
+ * under every sibling edge that comes before the one taken.
+ *
+ * @param word is the word to look up, in any case
+ * @return position of the word in the dictionary, or Missing if the graph
+ *         does not contain it
+ */
+uint32_t Dawg::locate(_In_ std::string_view word) const {
+	if (nodes.empty() || word.empty())
+		return Missing;
+
+	uint32_t node = Root;
+	uint32_t rank = 0;
+	for (char letter : word) {
+		letter = upper(letter);
+		Node const& current = nodes[node];
+		rank += current.terminal ? 1 : 0;
+
+		uint32_t next = Missing;
+		for (uint32_t i = 0; i < current.edgeCount; ++i) {
+			Edge const& candidate = edges[current.firstEdge + i];
+			if (candidate.letter == letter) {
+				next = candidate.target;
+				break;
+			}
+			rank += nodes[candidate.target].words;
+		}
+
+		if (next == Missing)
+			return Missing;
+		node = next;
+	}
+
+	return nodes[node].terminal ? position(rank) : Missing;
+}
+
+/**
+ * Finds the words that can be made from a rack
+ *
+ * Every edge that is taken spends a tile: the rack's own letter if one is
+ * left, otherwise a blank, which scores nothing. Characters that are not
+ * codes of the alphabet's tiles are free, matching the scores of the letter
+ * count index. A word's rank is accumulated on
+ * the way down by counting the words under every sibling edge that is
+ * skipped. A pattern's automaton is advanced along with every edge, so
+ * branches that no longer fit the pattern are never entered.
+ *
+ * @param index is the letter count index of the words, which holds the point
+ *        values of their tiles
+ * @param query contains the letters and filters
+ * @param matches receives the words that can be made
+ * @param buffer optionally holds the word being built, so its memory can be
+ *        reused from one call to the next
+ */
+void Dawg::find(_In_ WordIndex const& index, _In_ Query const& query,
+	_Inout_ std::vector<Match>& matches,
+	_Inout_opt_ std::string* buffer) const {
+	if (nodes.empty())
+		return;
+
+	RackSpender rack(query.letters, index);
+	std::string local;
+	std::string& word = buffer ? *buffer : local;
+	word.clear();
+
+	Pattern const* pattern = query.pattern;
+	Pattern::State state = pattern ? pattern->start() : 0;
+	uint32_t node = 0;
+	uint32_t rank = 0;
+	int total = 0;
+	for (char letter : query.startsWith) {
+		letter = upper(letter);
+		Node const& current = nodes[node];
+		uint32_t skipped = current.terminal ? 1 : 0;
+		Edge const* edge = nullptr;
+		for (uint32_t i = 0; i < current.edgeCount; ++i) {
+			Edge const& candidate = edges[current.firstEdge + i];
+			if (candidate.letter == letter) {
+				edge = &candidate;
+				break;
+			}
+			skipped += nodes[candidate.target].words;
+		}
+
+		int points = 0;
+		if (!edge || !rack.spend(letter, points))
+			return;
+		if (pattern) {
+			state = pattern->advance(state, letter);
+			if (!state)
+				return;
+		}
+
+		total += std::max(points, 0);
+		rank += skipped;
+		node = edge->target;
+		word.push_back(letter);
+	}
+
+	auto visit = [&](auto& self, _In_ uint32_t node, _In_ uint32_t rank,
+		_In_ int total, _In_ Pattern::State state) -> void {
+		if (word.length() <= query.startsWith.length() + 1
+			&& isCancelled(query))
+			return;
+
+		Node const& current = nodes[node];
+		if (current.terminal && (!pattern || pattern->accepts(state))
+			&& passesFilters(query, word))
+			matches.push_back({ position(rank), total });
+
+		rank += current.terminal ? 1 : 0;
+		for (uint32_t i = 0; i < current.edgeCount; ++i) {
+			Edge const& edge = edges[current.firstEdge + i];
+			Pattern::State next =
+				pattern ? pattern->advance(state, edge.letter) : 0;
+			int points = 0;
+			if ((!pattern || next) && rack.spend(edge.letter, points)) {
+				word.push_back(edge.letter);
+				self(self, edge.target, rank, total + std::max(points, 0),
+					next);
+				word.pop_back();
+				rack.refund(edge.letter, points);
+			}
+
+			rank += nodes[edge.target].words;
+		}
+	};
+
+	visit(visit, node, rank, total, state);
+}
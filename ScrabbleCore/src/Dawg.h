@@ -0,0 +1,168 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Directed acyclic word graph built from a dictionary
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sal.h>
+
+#include "Dictionary.h"
+#include "Query.h"
+#include "Table.h"
+#include "WordIndex.h"
+
+/**
+ * Minimal DAWG with word ranks for mapping paths back to the dictionary
+ *
+ * Built with the incremental algorithm for sorted input, so every identical
+ * suffix is shared and the graph is minimal. Each node stores the number of
+ * words reachable below it, which gives every word a rank equal to its
+ * position in sorted order without any per-word storage. Letters are stored
+ * in uppercase.
+ */
+class Dawg {
+public:
+	/**
+	 * Outgoing transition of a node
+	 */
+	struct Edge {
+		uint32_t target;
+		char letter;
+	};
+
+	/**
+	 * State of the graph, with its outgoing edges stored contiguously
+	 */
+	struct Node {
+		uint32_t firstEdge;
+		uint32_t words;
+		uint16_t edgeCount;
+		bool terminal;
+	};
+
+	/**
+	 * Index of the node that every word starts from
+	 */
+	static constexpr uint32_t Root = 0;
+
+	/**
+	 * Node index returned when an edge does not exist
+	 */
+	static constexpr uint32_t Missing = UINT32_MAX;
+
+	Dawg() = default;
+
+	/**
+	 * Builds the graph for every word in a dictionary
+	 *
+	 * Duplicate words are only added once.
+	 *
+	 * @param dictionary is the word list to build the graph from
+	 */
+	explicit Dawg(_In_ Dictionary const& dictionary);
+
+	/**
+	 * Builds the graph for a list of words
+	 *
+	 * @param words is the list of words to build the graph from, sorted
+	 *        while ignoring case and without duplicates, so every rank is
+	 *        the word's position in the list
+	 */
+	explicit Dawg(_In_ std::vector<std::string_view> const& words);
+
+	/**
+	 * @return number of nodes in the graph
+	 */
+	size_t nodeCount() const {
+		return nodes.size();
+	}
+
+	/**
+	 * @return number of edges in the graph
+	 */
+	size_t edgeCount() const {
+		return edges.size();
+	}
+
+	/**
+	 * @param index is the position of the node
+	 * @return node at the position
+	 */
+	Node const& node(_In_ uint32_t index) const {
+		return nodes[index];
+	}
+
+	/**
+	 * @param index is the position of the edge
+	 * @return edge at the position
+	 */
+	Edge const& edge(_In_ uint32_t index) const {
+		return edges[index];
+	}
+
+	/**
+	 * Follows the edge for one letter out of a node
+	 *
+	 * @param from is the node to leave
+	 * @param letter is the uppercase letter of the edge
+	 * @return node the edge leads to, or Missing if there is no such edge
+	 */
+	uint32_t follow(_In_ uint32_t from, _In_ char letter) const;
+
+	/**
+	 * Looks up the dictionary position of a word
+	 *
+	 * @param word is the word to look up, in any case
+	 * @return position of the word in the dictionary, or Missing if the
+	 *         graph does not contain it
+	 */
+	uint32_t locate(_In_ std::string_view word) const;
+
+	/**
+	 * Finds the words that can be made from a rack
+	 *
+	 * The starts with filter is followed directly down the graph, and only
+	 * branches that the remaining letters and blanks can still pay for and
+	 * that can still match the pattern are explored below it. Matches are
+	 * appended in alphabetical order.
+	 *
+	 * @param index is the letter count index of the words, which holds the
+	 *        point values of their tiles
+	 * @param query contains the letters and filters
+	 * @param matches receives the words that can be made
+	 * @param buffer optionally holds the word being built, so its memory
+	 *        can be reused from one call to the next
+	 */
+	void find(_In_ WordIndex const& index, _In_ Query const& query,
+		_Inout_ std::vector<Match>& matches,
+		_Inout_opt_ std::string* buffer = nullptr) const;
+
+private:
+	friend class LexiconImage;
+
+	void build(_In_ std::vector<std::string_view> const& words);
+	bool intact(_In_ size_t words) const;
+
+	/**
+	 * Maps a word's rank to its position in the dictionary
+	 *
+	 * @param rank is the position of the word in sorted order
+	 * @return position of the word in the dictionary
+	 */
+	uint32_t position(_In_ uint32_t rank) const {
+		return order.empty() ? rank : order[rank];
+	}
+
+	Table<Node> nodes;
+	Table<Edge> edges;
+	Table<uint32_t> order;
+};
@@ -0,0 +1,59 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Read-only word list backed by borrowed memory
+ */
+
+#include "Dictionary.h"
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+/**
+ * Builds a view over a block of text
+ *
+ * Each line of the block is recorded as an offset and length pair. Trailing
+ * carriage returns are excluded from the word and empty lines are ignored,
+ * so the final word does not need to be followed by a line ending. Each word
+ * is also compared with the one before it to find out whether the list is
+ * sorted.
+ *
+ * @param data is the start of the text block
+ * @param size is the length of the text block in bytes
+ * @param storage optionally keeps the memory behind the block alive
+ */
+Dictionary::Dictionary(_In_reads_(size) char const* data, _In_ size_t size,
+	_In_opt_ std::shared_ptr<void const> storage) : data(data),
+	storage(std::move(storage)) {
+	char const* end = data + size;
+	char const* line = data;
+	std::vector<Entry> lines;
+	while (line < end) {
+		char const* next = static_cast<char const*>(
+			memchr(line, '\n', static_cast<size_t>(end - line)));
+		if (!next)
+			next = end;
+
+		char const* last = next;
+		if (last > line && *(last - 1) == '\r')
+			--last;
+
+		if (last > line) {
+			std::string_view word(line, static_cast<size_t>(last - line));
+			if (!lines.empty() && word <= std::string_view(data
+				+ lines.back().offset, lines.back().length))
+				ascending = false;
+
+			lines.push_back({ static_cast<uint32_t>(line - data),
+				static_cast<uint32_t>(last - line) });
+		}
+
+		if (next == end)
+			break;
+		line = next + 1;
+	}
+
+	entries = Table<Entry>(std::move(lines));
+}
@@ -0,0 +1,92 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Read-only word list backed by borrowed memory
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include <sal.h>
+
+#include "Table.h"
+
+/**
+ * Word list that views a block of newline separated text in place
+ *
+ * The text is never copied. Instead, a single table of offsets and lengths is
+ * built that points into the original block, such as the memory returned by
+ * LockResource or a memory-mapped file. Both LF and CRLF line endings are
+ * accepted and blank lines are skipped.
+ */
+class Dictionary {
+public:
+	/**
+	 * Location of a single word inside of the viewed text
+	 */
+	struct Entry {
+		uint32_t offset;
+		uint32_t length;
+	};
+
+	Dictionary() = default;
+
+	/**
+	 * Builds a view over a block of text
+	 *
+	 * The block must remain valid for as long as the dictionary is used. If
+	 * the memory is owned by another object, it can be passed in as the
+	 * storage so the dictionary keeps it alive.
+	 *
+	 * @param data is the start of the text block
+	 * @param size is the length of the text block in bytes
+	 * @param storage optionally keeps the memory behind the block alive
+	 */
+	Dictionary(_In_reads_(size) char const* data, _In_ size_t size,
+		_In_opt_ std::shared_ptr<void const> storage = nullptr);
+
+	/**
+	 * @return number of words in the dictionary
+	 */
+	size_t size() const {
+		return entries.size();
+	}
+
+	/**
+	 * @return true if the dictionary does not contain any words
+	 */
+	bool empty() const {
+		return entries.empty();
+	}
+
+	/**
+	 * @return true if every word sorts strictly after the one before it, so
+	 *         positions can stand in for alphabetical order
+	 */
+	bool sorted() const {
+		return ascending;
+	}
+
+	/**
+	 * Looks up a word by its position in the dictionary
+	 *
+	 * @param index is the position of the word
+	 * @return view of the word inside of the text block
+	 */
+	std::string_view operator[](_In_ size_t index) const {
+		Entry const& entry = entries[index];
+		return std::string_view(data + entry.offset, entry.length);
+	}
+
+private:
+	friend class LexiconImage;
+
+	char const* data = nullptr;
+	Table<Entry> entries;
+	std::shared_ptr<void const> storage;
+	bool ascending = true;
+};
@@ -0,0 +1,157 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Loading of dictionaries from files and module resources
+ */
+
+#include "DictionaryLoader.h"
+
+#include <memory>
+#include <utility>
+
+#include <windows.h>
+
+#include "LexiconImage.h"
+#include "MappedFile.h"
+
+namespace {
+	/**
+	 * Locks a resource of a module in memory
+	 *
+	 * @param module is the handle of the module holding the resource
+	 * @param resource is the identifier of the resource
+	 * @param type is the type of the resource
+	 * @param size receives the length of the resource in bytes
+	 * @return start of the resource, or nullptr if it could not be found
+	 */
+	char const* lockResource(_In_ HMODULE module, _In_ int resource,
+		_In_ wchar_t const* type, _Out_ size_t& size) {
+		size = 0;
+		HRSRC resInfo = FindResourceW(module, MAKEINTRESOURCEW(resource),
+			type);
+		if (!resInfo)
+			return nullptr;
+
+		HGLOBAL resData = LoadResource(module, resInfo);
+		if (!resData)
+			return nullptr;
+
+		LPVOID res = LockResource(resData);
+		if (!res)
+			return nullptr;
+
+		size = SizeofResource(module, resInfo);
+		return static_cast<char const*>(res);
+	}
+}
+
+/**
+ * Loads an external dictionary file
+ *
+ * @param path is the location of the dictionary file
+ * @return dictionary viewing the file contents, or an empty dictionary if
+ *         the file could not be read
+ */
+Dictionary loadDictionary(_In_ wchar_t const* path) {
+	std::shared_ptr<MappedFile> file = MappedFile::open(path);
+	if (!file)
+		return {};
+
+	char const* data = file->data();
+	size_t size = file->size();
+	return Dictionary(data, size, std::move(file));
+}
+
+/**
+ * Loads a dictionary embedded as a resource of a module
+ *
+ * @param module is the handle of the module holding the resource
+ * @param resource is the identifier of the resource
+ * @return dictionary viewing the resource contents, or an empty dictionary
+ *         if the resource could not be found
+ */
+Dictionary loadDictionary(_In_ void* module, _In_ int resource) {
+	size_t size = 0;
+	char const* data = lockResource(static_cast<HMODULE>(module), resource,
+		L"TXT", size);
+	if (!data)
+		return {};
+
+	return Dictionary(data, size);
+}
+
+/**
+ * Loads an external dictionary file together with its indexes
+ *
+ * @param path is the location of the image or word list
+ * @param deferred is true to only build the letter count index of a word
+ *        list, leaving the others to Lexicon::build()
+ * @return lexicon viewing the file contents, or an empty lexicon if the file
+ *         could not be read
+ */
+Lexicon loadLexicon(_In_ wchar_t const* path, _In_ bool deferred) {
+	std::shared_ptr<MappedFile> file = MappedFile::open(path);
+	if (!file)
+		return {};
+
+	char const* data = file->data();
+	size_t size = file->size();
+	if (LexiconImage::recognizes(data, size))
+		return LexiconImage::open(data, size, std::move(file));
+
+	return Lexicon(Dictionary(data, size, std::move(file)), deferred);
+}
+
+/**
+ * Loads a lexicon embedded as a resource of a module
+ *
+ * @param module is the handle of the module holding the resource
+ * @param resource is the identifier of the resource
+ * @param deferred is true to only build the letter count index of a word
+ *        list, leaving the others to Lexicon::build()
+ * @return lexicon viewing the resource contents, or an empty lexicon if the
+ *         resource could not be found
+ */
+Lexicon loadLexicon(_In_ void* module, _In_ int resource,
+	_In_ bool deferred) {
+	size_t size = 0;
+	char const* data = lockResource(static_cast<HMODULE>(module), resource,
+		L"LEXICON", size);
+	if (data)
+		return LexiconImage::open(data, size, nullptr, false);
+
+	return Lexicon(loadDictionary(module, resource), deferred);
+}
+
+/**
+ * Loads the description of an alphabet
+ *
+ * @param path is the location of the description, in UTF-8
+ * @return alphabet, or an empty alphabet if the file could not be read or
+ *         is not a valid description
+ */
+Alphabet loadAlphabet(_In_ wchar_t const* path) {
+	std::shared_ptr<MappedFile> file = MappedFile::open(path);
+	if (!file)
+		return Alphabet::parse({});
+
+	return Alphabet::parse(std::string_view(file->data(), file->size()));
+}
+
+/**
+ * Loads a compiled table of leave values
+ *
+ * @param path is the location of the table image
+ * @return table viewing the file contents, or an empty table if the file
+ *         could not be read or is not a valid image
+ */
+LeaveTable loadLeaves(_In_ wchar_t const* path) {
+	std::shared_ptr<MappedFile> file = MappedFile::open(path);
+	if (!file)
+		return {};
+
+	char const* data = file->data();
+	size_t size = file->size();
+	return LeaveTable::open(data, size, std::move(file));
+}
@@ -0,0 +1,93 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Loading of dictionaries from files and module resources
+ */
+
+#pragma once
+
+#include <sal.h>
+
+#include "Alphabet.h"
+#include "Dictionary.h"
+#include "LeaveTable.h"
+#include "Lexicon.h"
+
+/**
+ * Loads an external dictionary file
+ *
+ * The file is memory-mapped and the returned dictionary views the mapping
+ * directly. The mapping is kept alive by the dictionary.
+ *
+ * @param path is the location of the dictionary file
+ * @return dictionary viewing the file contents, or an empty dictionary if
+ *         the file could not be read
+ */
+Dictionary loadDictionary(_In_ wchar_t const* path);
+
+/**
+ * Loads a dictionary embedded as a resource of a module
+ *
+ * The resource must be of type TXT. The returned dictionary views the
+ * resource memory directly, which stays valid for the lifetime of the
+ * module, so none of the words are copied.
+ *
+ * @param module is the handle of the module holding the resource
+ * @param resource is the identifier of the resource
+ * @return dictionary viewing the resource contents, or an empty dictionary
+ *         if the resource could not be found
+ */
+Dictionary loadDictionary(_In_ void* module, _In_ int resource);
+
+/**
+ * Loads an external dictionary file together with its indexes
+ *
+ * A file holding a compiled lexicon image is used in place after its
+ * checksum is verified. Any other file is read as a word list and indexed.
+ *
+ * @param path is the location of the image or word list
+ * @param deferred is true to only build the letter count index of a word
+ *        list, leaving the others to Lexicon::build()
+ * @return lexicon viewing the file contents, or an empty lexicon if the file
+ *         could not be read
+ */
+Lexicon loadLexicon(_In_ wchar_t const* path, _In_ bool deferred = false);
+
+/**
+ * Loads a lexicon embedded as a resource of a module
+ *
+ * A compiled image of type LEXICON is preferred and is used in place without
+ * being verified, as it is part of the module itself. Otherwise a word list
+ * of type TXT is looked up and indexed.
+ *
+ * @param module is the handle of the module holding the resource
+ * @param resource is the identifier of the resource
+ * @param deferred is true to only build the letter count index of a word
+ *        list, leaving the others to Lexicon::build()
+ * @return lexicon viewing the resource contents, or an empty lexicon if the
+ *         resource could not be found
+ */
+Lexicon loadLexicon(_In_ void* module, _In_ int resource,
+	_In_ bool deferred = false);
+
+/**
+ * Loads the description of an alphabet
+ *
+ * @param path is the location of the description, in UTF-8
+ * @return alphabet, or an empty alphabet if the file could not be read or
+ *         is not a valid description
+ */
+Alphabet loadAlphabet(_In_ wchar_t const* path);
+
+/**
+ * Loads a compiled table of leave values
+ *
+ * The file is memory-mapped and the returned table views the mapping
+ * directly. The mapping is kept alive by the table.
+ *
+ * @param path is the location of the table image
+ * @return table viewing the file contents, or an empty table if the file
+ *         could not be read or is not a valid image
+ */
+LeaveTable loadLeaves(_In_ wchar_t const* path);
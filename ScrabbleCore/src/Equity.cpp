@@ -0,0 +1,129 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Ranking of plays by their points together with the value of their leave
+ */
+
+#include "Equity.h"
+
+#include <algorithm>
+#include <string>
+
+#include "Board.h"
+#include "Rack.h"
+#include "Solver.h"
+#include "ThreadPool.h"
+
+namespace {
+	/**
+	 * Number of plays each task values
+	 */
+	constexpr size_t BlockSize = 1024;
+
+	/**
+	 * Finds the tiles a word leaves on a rack
+	 *
+	 * @param counts is the letter count record of the word
+	 * @param rack is the histogram of the available letters
+	 * @return histogram of the tiles that are not played
+	 */
+	Rack leaveOf(_In_reads_(WordIndex::Stride) uint8_t const* counts,
+		_In_ Rack const& rack) {
+		Rack leave = rack;
+		for (size_t k = 0; k < 26; ++k) {
+			uint8_t used = std::min(counts[k], rack.counts[k]);
+			leave.counts[k] = static_cast<uint8_t>(rack.counts[k] - used);
+			leave.blanks -= counts[k] - used;
+		}
+
+		return leave;
+	}
+
+	/**
+	 * @param rack is a histogram of tiles
+	 * @return number of tiles in the histogram, blanks included
+	 */
+	int tileCount(_In_ Rack const& rack) {
+		int tiles = rack.blanks;
+		for (size_t k = 0; k < WordIndex::Stride; ++k)
+			tiles += rack.counts[k];
+
+		return tiles;
+	}
+}
+
+/**
+ * Checks whether the plays of a rack can be ranked by equity
+ *
+ * @param letters is the rack in tile codes
+ * @return true if the rack holds no more tiles than a full rack
+ */
+bool fitsRack(_In_ std::string_view letters) {
+	return tileCount(makeRack(letters)) <= Board::RackSize;
+}
+
+/**
+ * Finds every word that can be made from a rack and ranks it by equity
+ *
+ * The words are found as usual, unsorted and without a limit, and then every
+ * one of them is valued in parallel before they are ranked. Only a play
+ * that empties a full rack earns the bingo bonus. Tiles on the board that
+ * the words run through are part of the words but never of the leave.
+ *
+ * @param lexicon is the dictionary and indexes that will be searched
+ * @param leaves holds the value of every leave
+ * @param query contains the letters, filters, engine and limit, while its
+ *        sorting method is ignored
+ * @return matching words from the highest equity to the lowest, or only
+ *         the best of them if the query has a limit, or nothing if the rack
+ *         holds more than Board::RackSize tiles
+ */
+std::vector<Play> evaluate(_In_ Lexicon const& lexicon,
+	_In_ LeaveTable const& leaves, _In_ Query const& query) {
+	Rack rack = makeRack(query.letters);
+	int held = tileCount(rack);
+	if (held > Board::RackSize)
+		return {};
+
+	Rack available = rack;
+	if (!query.through.empty())
+		available = makeRack(std::string(query.letters).append(
+			query.through));
+
+	Query search = query;
+	search.method = SortingMethod::None;
+	search.limit = 0;
+	std::vector<Match> matches = solve(lexicon, search);
+
+	WordIndex const& index = lexicon.index();
+	std::vector<Play> plays(matches.size());
+	size_t blocks = (matches.size() + BlockSize - 1) / BlockSize;
+	ThreadPool::shared().run(blocks, [&](_In_ size_t block) {
+		size_t last = std::min((block + 1) * BlockSize, matches.size());
+		for (size_t i = block * BlockSize; i < last; ++i) {
+			Match const& match = matches[i];
+			Rack kept = leaveOf(index.counts(match.index), available);
+			float leave = leaves.value(kept);
+			int bonus = held == Board::RackSize && tileCount(kept) == 0
+				? Board::Bingo : 0;
+			plays[i] = { match.index, match.points, leave,
+				match.points + bonus + leave };
+		}
+	});
+
+	auto better = [](_In_ Play const& a, _In_ Play const& b) {
+		if (a.equity != b.equity)
+			return a.equity > b.equity;
+		if (a.points != b.points)
+			return a.points > b.points;
+		return a.index < b.index;
+	};
+
+	size_t limit = query.limit ? std::min(query.limit, plays.size())
+		: plays.size();
+	std::partial_sort(plays.begin(), plays.begin() + limit, plays.end(),
+		better);
+	plays.resize(limit);
+	return plays;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Ranking of plays by their points together with the value of their leave
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include <sal.h>
+
+#include "LeaveTable.h"
+#include "Lexicon.h"
+#include "Query.h"
+
+/**
+ * Word that can be made from a rack, with the value of the tiles it keeps
+ *
+ * The equity is the points of the word, with the bingo bonus if it uses
+ * every tile of a full rack, plus the value of its leave.
+ */
+struct Play {
+	uint32_t index;
+	int points;
+	float leave;
+	float equity;
+};
+
+/**
+ * Checks whether the plays of a rack can be ranked by equity
+ *
+ * @param letters is the rack in tile codes
+ * @return true if the rack holds no more tiles than a full rack
+ */
+bool fitsRack(_In_ std::string_view letters);
+
+/**
+ * Finds every word that can be made from a rack and ranks it by equity
+ *
+ * Blanks cover the letters of a word that the rack lacks, and any others
+ * are kept. A rack of more than seven tiles has leaves that the table holds
+ * no value for, so it is not ranked at all.
+ *
+ * @param lexicon is the dictionary and indexes that will be searched
+ * @param leaves holds the value of every leave
+ * @param query contains the letters, filters, engine and limit, while its
+ *        sorting method is ignored
+ * @return matching words from the highest equity to the lowest, or only
+ *         the best of them if the query has a limit, or nothing if the rack
+ *         holds more than seven tiles
+ */
+std::vector<Play> evaluate(_In_ Lexicon const& lexicon,
+	_In_ LeaveTable const& leaves, _In_ Query const& query);
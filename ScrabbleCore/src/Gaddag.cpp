@@ -0,0 +1,264 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * GADDAG built from a dictionary for searches that start inside a word
+ */
+
+#include "Gaddag.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "Rack.h"
+#include "Solver.h"
+
+/**
+ * Builds the graph for every word in a dictionary
+ *
+ * Every split of every word is written into one block of text, so the paths
+ * can be sorted as views without a separate allocation each. Duplicate paths
+ * are dropped, and the rest are handed to the DAWG builder, which shares
+ * their common suffixes.
+ *
+ * @param dictionary is the word list to build the graph from
+ */
+Gaddag::Gaddag(_In_ Dictionary const& dictionary) {
+	size_t total = 0;
+	for (size_t i = 0; i < dictionary.size(); ++i) {
+		size_t length = dictionary[i].length();
+		total += length * (length + 1);
+	}
+
+	std::string text;
+	std::vector<std::pair<size_t, size_t>> spans;
+	text.reserve(total);
+	for (size_t i = 0; i < dictionary.size(); ++i) {
+		std::string_view word = dictionary[i];
+		for (size_t split = 1; split <= word.length(); ++split) {
+			size_t start = text.length();
+			for (size_t j = split; j > 0; --j)
+				text.push_back(upper(word[j - 1]));
+			if (split < word.length()) {
+				text.push_back(Separator);
+				for (size_t j = split; j < word.length(); ++j)
+					text.push_back(upper(word[j]));
+			}
+
+			spans.emplace_back(start, text.length() - start);
+		}
+	}
+
+	std::vector<std::string_view> paths(spans.size());
+	for (size_t i = 0; i < spans.size(); ++i)
+		paths[i] = std::string_view(text).substr(spans[i].first,
+			spans[i].second);
+
+	std::sort(paths.begin(), paths.end());
+	paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+	graph = Dawg(paths);
+}
+
+/**
+ * Finds the words that can be made from a rack and contain a fragment
+ *
+ * A query with tiles on the board starts from them. Otherwise, a query
+ * without a contains filter has nothing to start from, so it is solved by
+ * the DAWG instead.
+ *
+ * @param words is the DAWG of the dictionary, used to map the words found
+ *        back to their positions
+ * @param index is the letter count index of the dictionary, which holds the
+ *        point values of its tiles
+ * @param query contains the letters and filters
+ * @param matches receives the words that can be made, in dictionary order
+ */
+void Gaddag::find(_In_ Dawg const& words, _In_ WordIndex const& index,
+	_In_ Query const& query, _Inout_ std::vector<Match>& matches) const {
+	if (!query.through.empty() && query.hook)
+		hooks(words, index, query.through, query.offset, query, matches);
+	else if (!query.through.empty())
+		through(words, index, query.through, query.offset, query, matches);
+	else if (query.contains.empty())
+		words.find(index, query, matches);
+	else
+		search(words, index, query.contains, false, Anywhere, query, matches);
+}
+
+/**
+ * Finds the words that run through tiles already on the board
+ *
+ * @param words is the DAWG of the dictionary, used to map the words found
+ *        back to their positions
+ * @param index is the letter count index of the dictionary, which holds the
+ *        point values of its tiles
+ * @param tiles are the letters on the board, in order
+ * @param offset is the position of the first tile in the word, or Anywhere
+ * @param query contains the letters and filters
+ * @param matches receives the words that can be made, in dictionary order
+ */
+void Gaddag::through(_In_ Dawg const& words, _In_ WordIndex const& index,
+	_In_ std::string_view tiles, _In_ size_t offset, _In_ Query const& query,
+	_Inout_ std::vector<Match>& matches) const {
+	search(words, index, tiles, true, offset, query, matches);
+}
+
+/**
+ * Finds the longer words that an existing word can be extended into
+ *
+ * @param words is the DAWG of the dictionary, used to map the words found
+ *        back to their positions
+ * @param index is the letter count index of the dictionary, which holds the
+ *        point values of its tiles
+ * @param word is the word on the board
+ * @param offset is the position of the word on the board in the longer
+ *        word, or Anywhere
+ * @param query contains the letters and filters
+ * @param matches receives the words that can be made, in dictionary order
+ */
+void Gaddag::hooks(_In_ Dawg const& words, _In_ WordIndex const& index,
+	_In_ std::string_view word, _In_ size_t offset, _In_ Query const& query,
+	_Inout_ std::vector<Match>& matches) const {
+	size_t found = matches.size();
+	through(words, index, word, offset, query, matches);
+
+	uint32_t itself = words.locate(word);
+	matches.erase(std::remove_if(matches.begin() + found, matches.end(),
+		[itself](_In_ Match const& match) {
+			return match.index == itself;
+		}), matches.end());
+}
+
+/**
+ * Finds the words around a fragment
+ *
+ * The fragment is walked backwards from the root. From there, each letter
+ * taken grows the word by one to the left, and at any point where the
+ * fragment may sit, the path either ends, which means the word ends with
+ * the fragment, or crosses the separator and grows the word to the right.
+ * Every letter that is not free spends a tile from the rack: its own letter
+ * if one is left, otherwise a blank, which scores nothing. A free letter
+ * scores its tile's value, unless it is lowercase and so a blank. A word
+ * that holds the fragment more than once is found once for each, so only its
+ * best score is kept.
+ *
+ * @param words is the DAWG of the dictionary, used to map the words found
+ *        back to their positions
+ * @param index is the letter count index of the dictionary, which holds the
+ *        point values of its tiles
+ * @param fragment is the run of letters every word must contain
+ * @param free is true if the fragment is already on the board, so its
+ *        letters cost nothing, or false if the rack pays for them
+ * @param offset is the position of the fragment in the word, or Anywhere
+ * @param query contains the letters and filters
+ * @param matches receives the words that can be made, in dictionary order
+ */
+void Gaddag::search(_In_ Dawg const& words, _In_ WordIndex const& index,
+	_In_ std::string_view fragment, _In_ bool free, _In_ size_t offset,
+	_In_ Query const& query, _Inout_ std::vector<Match>& matches) const {
+	if (!graph.nodeCount() || fragment.empty())
+		return;
+
+	RackSpender rack(query.letters, index);
+
+	uint32_t start = Dawg::Root;
+	int total = 0;
+	std::string middle;
+	for (size_t i = fragment.length(); i > 0; --i) {
+		char tile = fragment[i - 1];
+		char letter = upper(tile);
+		start = graph.follow(start, letter);
+		if (start == Dawg::Missing)
+			return;
+
+		int points = 0;
+		if (free) {
+			int code = rack.tileOf(tile);
+			if (code >= 0 && (tile < 'a' || tile > 'z'))
+				points = rack.value(code);
+		} else if (!rack.spend(letter, points))
+			return;
+
+		total += std::max(points, 0);
+		middle.insert(middle.begin(), letter);
+	}
+
+	size_t found = matches.size();
+	std::string before;
+	std::string after;
+	std::string word;
+
+	auto record = [&](_In_ int total) {
+		word.assign(before.rbegin(), before.rend());
+		word.append(middle);
+		word.append(after);
+		if (!passesFilters(query, word))
+			return;
+
+		uint32_t position = words.locate(word);
+		if (position != Dawg::Missing)
+			matches.push_back({ position, total });
+	};
+
+	auto right = [&](auto& self, _In_ uint32_t node, _In_ int total) -> void {
+		Dawg::Node const& current = graph.node(node);
+		if (current.terminal)
+			record(total);
+
+		for (uint32_t i = 0; i < current.edgeCount; ++i) {
+			Dawg::Edge const& edge = graph.edge(current.firstEdge + i);
+			int points = 0;
+			if (!rack.spend(edge.letter, points))
+				continue;
+
+			after.push_back(edge.letter);
+			self(self, edge.target, total + std::max(points, 0));
+			after.pop_back();
+			rack.refund(edge.letter, points);
+		}
+	};
+
+	auto left = [&](auto& self, _In_ uint32_t node, _In_ int total) -> void {
+		if (before.length() <= 1 && isCancelled(query))
+			return;
+
+		Dawg::Node const& current = graph.node(node);
+		if (offset == Anywhere || before.length() == offset) {
+			if (current.terminal)
+				record(total);
+
+			uint32_t next = graph.follow(node, Separator);
+			if (next != Dawg::Missing)
+				right(right, next, total);
+		}
+
+		if (offset != Anywhere && before.length() >= offset)
+			return;
+
+		for (uint32_t i = 0; i < current.edgeCount; ++i) {
+			Dawg::Edge const& edge = graph.edge(current.firstEdge + i);
+			int points = 0;
+			if (edge.letter == Separator || !rack.spend(edge.letter, points))
+				continue;
+
+			before.push_back(edge.letter);
+			self(self, edge.target, total + std::max(points, 0));
+			before.pop_back();
+			rack.refund(edge.letter, points);
+		}
+	};
+
+	left(left, start, total);
+
+	std::sort(matches.begin() + found, matches.end(), [](
+		_In_ Match const& a, _In_ Match const& b) {
+			if (a.index != b.index)
+				return a.index < b.index;
+			return a.points > b.points;
+		});
+	matches.erase(std::unique(matches.begin() + found, matches.end(), [](
+		_In_ Match const& a, _In_ Match const& b) {
+			return a.index == b.index;
+		}), matches.end());
+}
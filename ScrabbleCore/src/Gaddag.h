@@ -0,0 +1,138 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * GADDAG built from a dictionary for searches that start inside a word
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include <sal.h>
+
+#include "Dawg.h"
+#include "Dictionary.h"
+#include "Query.h"
+#include "WordIndex.h"
+
+/**
+ * Word graph that can be entered at any letter of a word
+ *
+ * Every word of length n is stored n times, once for each way of splitting
+ * it in two: the first part reversed, a separator, then the second part. The
+ * separator is left out when the whole word is reversed. A search for words
+ * around a fragment walks the fragment backwards from the root, grows the
+ * word to the left, and crosses the separator to grow it to the right, so
+ * only words that really contain the fragment are ever visited. The paths
+ * are minimized like a DAWG, but the graph is still several times larger
+ * than the DAWG of the same words, which is why a lexicon only builds it
+ * when it is first needed.
+ */
+class Gaddag {
+public:
+	/**
+	 * Character marking where the reversed part of a path ends
+	 */
+	static constexpr char Separator = '>';
+
+	/**
+	 * Offset that lets a fragment appear anywhere in a word, which is also
+	 * the offset of a query that does not give one
+	 */
+	static constexpr size_t Anywhere = SIZE_MAX;
+
+	Gaddag() = default;
+
+	/**
+	 * Builds the graph for every word in a dictionary
+	 *
+	 * @param dictionary is the word list to build the graph from
+	 */
+	explicit Gaddag(_In_ Dictionary const& dictionary);
+
+	/**
+	 * @return number of nodes in the graph
+	 */
+	size_t nodeCount() const {
+		return graph.nodeCount();
+	}
+
+	/**
+	 * @return number of edges in the graph
+	 */
+	size_t edgeCount() const {
+		return graph.edgeCount();
+	}
+
+	/**
+	 * Finds the words that can be made from a rack and contain a fragment
+	 *
+	 * The contains filter is the fragment, and its letters are paid for by
+	 * the rack like any others. A query with tiles on the board is passed
+	 * to through() or hooks() instead.
+	 *
+	 * @param words is the DAWG of the dictionary, used to map the words
+	 *        found back to their positions
+	 * @param index is the letter count index of the dictionary, which holds
+	 *        the point values of its tiles
+	 * @param query contains the letters and filters
+	 * @param matches receives the words that can be made, in dictionary
+	 *        order
+	 */
+	void find(_In_ Dawg const& words, _In_ WordIndex const& index,
+		_In_ Query const& query, _Inout_ std::vector<Match>& matches) const;
+
+	/**
+	 * Finds the words that run through tiles already on the board
+	 *
+	 * The tiles are free, and every other letter of a word is paid for by
+	 * the rack. The filters and pattern of the query still apply, while its
+	 * own tiles on the board are ignored.
+	 *
+	 * @param words is the DAWG of the dictionary, used to map the words
+	 *        found back to their positions
+	 * @param index is the letter count index of the dictionary, which holds
+	 *        the point values of its tiles
+	 * @param tiles are the letters on the board, in order
+	 * @param offset is the position of the first tile in the word, or
+	 *        Anywhere
+	 * @param query contains the letters and filters
+	 * @param matches receives the words that can be made, in dictionary
+	 *        order
+	 */
+	void through(_In_ Dawg const& words, _In_ WordIndex const& index,
+		_In_ std::string_view tiles, _In_ size_t offset,
+		_In_ Query const& query, _Inout_ std::vector<Match>& matches) const;
+
+	/**
+	 * Finds the longer words that an existing word can be extended into
+	 *
+	 * Like through() with the existing word as the tiles, except that at
+	 * least one letter has to come from the rack.
+	 *
+	 * @param words is the DAWG of the dictionary, used to map the words
+	 *        found back to their positions
+	 * @param index is the letter count index of the dictionary, which holds
+	 *        the point values of its tiles
+	 * @param word is the word on the board
+	 * @param offset is the position of the word on the board in the longer
+	 *        word, or Anywhere
+	 * @param query contains the letters and filters
+	 * @param matches receives the words that can be made, in dictionary
+	 *        order
+	 */
+	void hooks(_In_ Dawg const& words, _In_ WordIndex const& index,
+		_In_ std::string_view word, _In_ size_t offset,
+		_In_ Query const& query, _Inout_ std::vector<Match>& matches) const;
+
+private:
+	void search(_In_ Dawg const& words, _In_ WordIndex const& index,
+		_In_ std::string_view fragment, _In_ bool free, _In_ size_t offset,
+		_In_ Query const& query, _Inout_ std::vector<Match>& matches) const;
+
+	Dawg graph;
+};
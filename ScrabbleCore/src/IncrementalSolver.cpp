@@ -0,0 +1,146 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Solver that narrows its previous results instead of searching again
+ */
+
+#include "IncrementalSolver.h"
+
+#include <utility>
+
+#include "Rack.h"
+#include "Solver.h"
+#include "Trace.h"
+
+/**
+ * Finds words that can be made from a list of letters
+ *
+ * When the query narrows the previous one, the previous matches are checked
+ * against the new rack and filters, and their points are recalculated since
+ * a smaller rack may need more blanks. The surviving matches are only sorted
+ * again if their order could have changed. A query with a limit is always
+ * solved in full and is not remembered, since narrowing its best matches
+ * could miss words that were ranked below the limit. A cancelled query
+ * leaves the previous results in place. When narrowing a traced query, the
+ * checks of the previous matches are recorded as its search.
+ *
+ * @param query contains the letters, filters, sorting method and engine
+ * @return matching words in the order given by the sorting method, which
+ *         stay valid until the next call
+ */
+std::vector<Match> const& IncrementalSolver::solve(_In_ Query const& query) {
+	static std::vector<Match> const none;
+
+	if (query.limit) {
+		std::vector<Match> found = ::solve(lexicon, query);
+		if (isCancelled(query))
+			return none;
+
+		reset();
+		matches = std::move(found);
+		return matches;
+	}
+
+	if (!narrows(query)) {
+		std::vector<Match> found = ::solve(lexicon, query);
+		if (isCancelled(query))
+			return none;
+
+		matches = std::move(found);
+	} else {
+		Dictionary const& dictionary = lexicon.dictionary();
+		WordIndex const& index = lexicon.index();
+		Profile* profile = Tracing ? query.profile : nullptr;
+		Rack rack = makeRack(query.letters);
+		bool rescored = query.letters != letters;
+		if (profile)
+			profile->count(Counter::Scanned, matches.size());
+
+		std::vector<Match> narrowed;
+		narrowed.reserve(matches.size());
+		{
+			ScopedTimer search(profile, Stage::Search);
+			for (size_t i = 0; i < matches.size(); ++i) {
+				if (i % 4096 == 0 && isCancelled(query))
+					return none;
+
+				uint32_t position = matches[i].index;
+				uint8_t const* counts = index.counts(position);
+				if (!isFeasible(counts, rack)) {
+					if (profile)
+						profile->count(Counter::RejectedByRack);
+					continue;
+				}
+
+				if (!passesFilters(query, dictionary[position])) {
+					if (profile)
+						profile->reject(query, dictionary[position]);
+					continue;
+				}
+
+				int points = matches[i].points;
+				if (rescored)
+					points = index.score(position)
+						- blankPenalty(counts, rack, index.values());
+				narrowed.push_back({ position, points });
+			}
+		}
+
+		if (rescored || query.method != method) {
+			ScopedTimer sort(profile, Stage::Sort);
+			sortMatches(dictionary, query.method, narrowed);
+		}
+
+		matches = std::move(narrowed);
+		if (profile)
+			profile->count(Counter::Matches, matches.size());
+	}
+
+	cached = true;
+	letters = query.letters;
+	startsWith = query.startsWith;
+	endsWith = query.endsWith;
+	contains = query.contains;
+	patterned = query.pattern != nullptr;
+	pattern = patterned ? query.pattern->text() : std::string_view();
+	method = query.method;
+	return matches;
+}
+
+/**
+ * Checks whether every match of a query is also a match of the previous one
+ *
+ * That is the case when the new filters extend the old ones, the pattern is
+ * new or unchanged and the new rack is contained in the old rack.
+ *
+ * @param query is the new query
+ * @return true if the previous matches can be narrowed down
+ */
+bool IncrementalSolver::narrows(_In_ Query const& query) const {
+	if (!cached)
+		return false;
+
+	std::string_view prefix = query.startsWith;
+	std::string_view suffix = query.endsWith;
+	if (prefix.substr(0, startsWith.length()) != startsWith)
+		return false;
+	if (suffix.length() < endsWith.length()
+		|| suffix.substr(suffix.length() - endsWith.length()) != endsWith)
+		return false;
+	if (query.contains.find(contains) == std::string_view::npos)
+		return false;
+	if (patterned && (!query.pattern || query.pattern->text() != pattern))
+		return false;
+
+	Rack previous = makeRack(letters);
+	Rack current = makeRack(query.letters);
+	if (current.blanks > previous.blanks)
+		return false;
+	for (size_t i = 0; i < WordIndex::Stride; ++i) {
+		if (current.counts[i] > previous.counts[i])
+			return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Solver that narrows its previous results instead of searching again
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <sal.h>
+
+#include "Lexicon.h"
+#include "Query.h"
+
+/**
+ * Remembers the most recent query so the next one can reuse its results
+ *
+ * While typing, most queries only tighten the one before: a letter is added
+ * to the starts with or contains filter or to the front of the ends with
+ * filter, a pattern is given where there was none, or a tile is removed
+ * from the rack. Every word that passes such a query also passed the
+ * previous one, so it is enough to check the previous matches again instead
+ * of searching the whole dictionary. Anything else falls back to a full
+ * solve.
+ */
+class IncrementalSolver {
+public:
+	/**
+	 * @param lexicon is the dictionary and indexes to search, which must
+	 *        outlive the solver
+	 */
+	explicit IncrementalSolver(_In_ Lexicon const& lexicon) :
+		lexicon(lexicon) {
+	}
+
+	/**
+	 * Finds words that can be made from a list of letters
+	 *
+	 * @param query contains the letters, filters, sorting method and engine
+	 * @return matching words in the order given by the sorting method, which
+	 *         stay valid until the next call
+	 */
+	std::vector<Match> const& solve(_In_ Query const& query);
+
+	/**
+	 * Forgets the previous results
+	 */
+	void reset() {
+		cached = false;
+		matches.clear();
+	}
+
+private:
+	bool narrows(_In_ Query const& query) const;
+
+	Lexicon const& lexicon;
+	bool cached = false;
+	std::string letters;
+	std::string startsWith;
+	std::string endsWith;
+	std::string contains;
+	std::string pattern;
+	bool patterned = false;
+	SortingMethod method = SortingMethod::None;
+	std::vector<Match> matches;
+};
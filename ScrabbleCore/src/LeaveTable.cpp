@@ -0,0 +1,486 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Precomputed values of every rack leave
+ */
+
+#include "LeaveTable.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "Board.h"
+#include "Scoring.h"
+#include "ThreadPool.h"
+
+namespace {
+	/**
+	 * Number of different tiles, which are the letters and then the blank
+	 */
+	constexpr size_t Kinds = 27;
+
+	/**
+	 * Position of the blank among the tiles
+	 */
+	constexpr size_t Blank = 26;
+
+	/**
+	 * Number of rack sizes, from empty to full
+	 */
+	constexpr size_t Sizes = LeaveTable::RackSize + 1;
+
+	/**
+	 * Number of racks each task of a parallel pass works through
+	 */
+	constexpr size_t BlockSize = 4096;
+
+	static_assert(LeaveTable::RackSize == Board::RackSize,
+		"leaves are counted on the board's rack");
+
+	/**
+	 * Counts needed to number the racks a bag can hold
+	 *
+	 * Racks are ordered by their size, then by their number of the first
+	 * kind of tile, then the second and so on. The racks of a size that
+	 * come before a rack are then counted one kind at a time: for each kind,
+	 * the racks that agree with it on every earlier kind and hold fewer of
+	 * this one.
+	 */
+	struct Layout {
+		uint8_t caps[Kinds];
+		uint32_t bag;
+		uint32_t offsets[Sizes + 1];
+
+		/**
+		 * Number of racks of r tiles from the kinds after k onwards that,
+		 * added to fewer than c tiles of kind k, make r tiles
+		 */
+		uint32_t prefix[Kinds][Sizes][Sizes];
+	};
+
+	/**
+	 * @return layout of the racks a full English bag can hold
+	 */
+	constexpr Layout makeLayout() {
+		Layout layout = {};
+		for (size_t k = 0; k < Blank; ++k)
+			layout.caps[k] = Tiles<TileSet::Standard>::counts[k];
+		layout.caps[Blank] = Tiles<TileSet::Standard>::blanks;
+		for (size_t k = 0; k < Kinds; ++k)
+			layout.bag += layout.caps[k];
+
+		uint32_t ways[Kinds + 1][Sizes] = {};
+		ways[Kinds][0] = 1;
+		for (size_t k = Kinds; k-- > 0;) {
+			for (size_t r = 0; r < Sizes; ++r) {
+				for (size_t c = 0; c <= r && c <= layout.caps[k]; ++c)
+					ways[k][r] += ways[k + 1][r - c];
+			}
+		}
+
+		for (size_t k = 0; k < Kinds; ++k) {
+			for (size_t r = 0; r < Sizes; ++r) {
+				for (size_t c = 1; c <= r; ++c)
+					layout.prefix[k][r][c] = layout.prefix[k][r][c - 1]
+						+ ways[k + 1][r - c + 1];
+			}
+		}
+
+		for (size_t size = 0; size < Sizes; ++size)
+			layout.offsets[size + 1] = layout.offsets[size] + ways[0][size];
+		return layout;
+	}
+
+	constexpr Layout Bag = makeLayout();
+
+	/**
+	 * Fixed-size start of an image
+	 */
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t rackSize;
+		uint8_t caps[32];
+		uint64_t count;
+	};
+
+	constexpr char Magic[8] = { 'S', 'C', 'R', 'A', 'B', 'L', 'V', 'S' };
+
+	/**
+	 * Numbers a rack
+	 *
+	 * @param tiles holds the number of each kind of tile
+	 * @return number of the rack, or LeaveTable::npos if no bag holds it
+	 */
+	size_t rank(_In_reads_(Kinds) uint8_t const* tiles) {
+		size_t total = 0;
+		for (size_t k = 0; k < Kinds; ++k) {
+			if (tiles[k] > Bag.caps[k])
+				return LeaveTable::npos;
+			total += tiles[k];
+		}
+
+		if (total > LeaveTable::RackSize)
+			return LeaveTable::npos;
+
+		size_t number = Bag.offsets[total];
+		size_t remaining = total;
+		for (size_t k = 0; k < Kinds && remaining; ++k) {
+			number += Bag.prefix[k][remaining][tiles[k]];
+			remaining -= tiles[k];
+		}
+
+		return number;
+	}
+
+	/**
+	 * Finds the rack with a number
+	 *
+	 * @param number is the number of a rack in the table
+	 * @param tiles receives the number of each kind of tile
+	 * @return number of tiles in the rack
+	 */
+	size_t unrank(_In_ size_t number, _Out_writes_(Kinds) uint8_t* tiles) {
+		size_t total = 0;
+		while (number >= Bag.offsets[total + 1])
+			++total;
+
+		number -= Bag.offsets[total];
+		size_t remaining = total;
+		for (size_t k = 0; k < Kinds; ++k) {
+			size_t most = std::min<size_t>(remaining, Bag.caps[k]);
+			size_t count = 0;
+			while (count < most && Bag.prefix[k][remaining][count + 1]
+				<= number)
+				++count;
+
+			number -= Bag.prefix[k][remaining][count];
+			tiles[k] = static_cast<uint8_t>(count);
+			remaining -= count;
+		}
+
+		return total;
+	}
+
+	/**
+	 * Moves to the next rack of the same size
+	 *
+	 * The last kind that can take one more tile from the kinds after it
+	 * does, and those kinds are then refilled with the rest of their tiles
+	 * packed as far to the end as they go.
+	 *
+	 * @param tiles holds the number of each kind of tile, which is changed
+	 *        to the next rack
+	 */
+	void advance(_Inout_updates_(Kinds) uint8_t* tiles) {
+		size_t after = tiles[Blank];
+		for (size_t k = Blank; k-- > 0;) {
+			if (after && tiles[k] < Bag.caps[k]) {
+				++tiles[k];
+				--after;
+				for (size_t j = Kinds; j-- > k + 1;) {
+					tiles[j] = static_cast<uint8_t>(
+						std::min<size_t>(after, Bag.caps[j]));
+					after -= tiles[j];
+				}
+				return;
+			}
+
+			after += tiles[k];
+		}
+	}
+
+	/**
+	 * Numbers the racks one tile away from a rack
+	 *
+	 * Taking a tile out of a kind or adding one to it only changes the
+	 * counts of that kind and the kinds before it, so each neighbor is
+	 * found from running sums instead of numbering it from scratch.
+	 *
+	 * @param tiles holds the number of each kind of tile
+	 * @param total is the number of tiles in the rack
+	 * @param smaller receives the rack with one less of each kind, or
+	 *        LeaveTable::npos if there is none of it
+	 * @param larger receives the rack with one more of each kind, or
+	 *        LeaveTable::npos if a bag has no more of it or the rack is full
+	 */
+	void neighbors(_In_reads_(Kinds) uint8_t const* tiles,
+		_In_ size_t total, _Out_writes_(Kinds) size_t* smaller,
+		_Out_writes_(Kinds) size_t* larger) {
+		size_t remaining[Kinds] = {};
+		size_t after[Kinds + 1] = {};
+		size_t left = total;
+		for (size_t k = 0; k < Kinds; ++k) {
+			remaining[k] = left;
+			left -= tiles[k];
+		}
+
+		for (size_t k = Kinds; k-- > 0;)
+			after[k] = after[k + 1] + Bag.prefix[k][remaining[k]][tiles[k]];
+
+		size_t fewer = total ? Bag.offsets[total - 1] : 0;
+		size_t more = Bag.offsets[total + 1];
+		for (size_t k = 0; k < Kinds; ++k) {
+			size_t r = remaining[k];
+			smaller[k] = LeaveTable::npos;
+			if (tiles[k])
+				smaller[k] = fewer + Bag.prefix[k][r - 1][tiles[k] - 1]
+					+ after[k + 1];
+
+			larger[k] = LeaveTable::npos;
+			if (total < LeaveTable::RackSize && tiles[k] < Bag.caps[k])
+				larger[k] = more + Bag.prefix[k][r + 1][tiles[k] + 1]
+					+ after[k + 1];
+
+			if (r > tiles[k])
+				fewer += Bag.prefix[k][r - 1][tiles[k]];
+			if (total < LeaveTable::RackSize)
+				more += Bag.prefix[k][r + 1][tiles[k]];
+		}
+	}
+
+	/**
+	 * Runs through every rack of one size on the shared thread pool
+	 *
+	 * @param size is the number of tiles in each rack
+	 * @param visit is called with the number and tiles of each rack
+	 */
+	template<typename Visit>
+	void forEachRack(_In_ size_t size, _In_ Visit const& visit) {
+		size_t first = Bag.offsets[size];
+		size_t last = Bag.offsets[size + 1];
+		size_t blocks = (last - first + BlockSize - 1) / BlockSize;
+		ThreadPool::shared().run(blocks, [&](_In_ size_t block) {
+			size_t begin = first + block * BlockSize;
+			size_t end = std::min(begin + BlockSize, last);
+			uint8_t tiles[Kinds] = {};
+			unrank(begin, tiles);
+			for (size_t number = begin; number < end; ++number) {
+				visit(number, tiles);
+				advance(tiles);
+			}
+		});
+	}
+
+	/**
+	 * Records a word against the rack that spells it exactly
+	 *
+	 * @param tiles holds the number of each kind of tile the word uses
+	 * @param points is the score of the word with those tiles
+	 * @param spelled holds the best score of each rack, which is raised to
+	 *        the word's if it is higher
+	 */
+	void record(_In_reads_(Kinds) uint8_t const* tiles, _In_ int points,
+		_Inout_ std::vector<int16_t>& spelled) {
+		size_t number = rank(tiles);
+		if (number != LeaveTable::npos)
+			spelled[number] = std::max(spelled[number],
+				static_cast<int16_t>(points));
+	}
+}
+
+/**
+ * Computes the value of every leave
+ *
+ * First, every word is recorded against the racks that spell it using all
+ * of their tiles, with up to two of its letters played as blanks. Then the
+ * best score of each rack is the larger of its own word's and the best
+ * score left after taking out any one tile, found for the small racks
+ * first. Going back down, a rack that is not full is expected to score the
+ * average of the racks one tile larger, weighted by how many of each tile
+ * are left in the bag. Each pass works on one rack size at a time, in
+ * parallel, since racks of the same size only depend on racks of another.
+ *
+ * @param index is the letter count index of the words that can be played
+ */
+LeaveTable::LeaveTable(_In_ WordIndex const& index) {
+	std::vector<int16_t> spelled(Bag.offsets[Sizes], -1);
+	uint8_t const* values = Tiles<TileSet::Standard>::values;
+	for (size_t position = 0; position < index.size(); ++position) {
+		size_t length = static_cast<size_t>(index.length(position));
+		if (!length || length > RackSize)
+			continue;
+
+		uint8_t tiles[Kinds] = {};
+		uint8_t const* counts = index.counts(position);
+		size_t letters = 0;
+		for (size_t k = 0; k < Blank; ++k) {
+			tiles[k] = counts[k];
+			letters += counts[k];
+		}
+
+		if (letters != length)
+			continue;
+
+		int points = index.score(position);
+		record(tiles, points, spelled);
+		for (size_t a = 0; a < Blank; ++a) {
+			if (!tiles[a])
+				continue;
+
+			--tiles[a];
+			++tiles[Blank];
+			record(tiles, points - values[a], spelled);
+			for (size_t b = a; b < Blank; ++b) {
+				if (!tiles[b])
+					continue;
+
+				--tiles[b];
+				++tiles[Blank];
+				record(tiles, points - values[a] - values[b], spelled);
+				++tiles[b];
+				--tiles[Blank];
+			}
+
+			++tiles[a];
+			--tiles[Blank];
+		}
+	}
+
+	std::vector<float> expected(spelled.size());
+	for (size_t size = 0; size < Sizes; ++size) {
+		forEachRack(size, [&](_In_ size_t number,
+			_In_reads_(Kinds) uint8_t const* tiles) {
+			size_t smaller[Kinds] = {};
+			size_t larger[Kinds] = {};
+			neighbors(tiles, size, smaller, larger);
+
+			float best = 0;
+			if (spelled[number] >= 0)
+				best = static_cast<float>(spelled[number]
+					+ (size == RackSize ? Board::Bingo : 0));
+			for (size_t k = 0; k < Kinds; ++k) {
+				if (smaller[k] != npos)
+					best = std::max(best, expected[smaller[k]]);
+			}
+
+			expected[number] = best;
+		});
+	}
+
+	for (size_t size = RackSize; size-- > 0;) {
+		forEachRack(size, [&](_In_ size_t number,
+			_In_reads_(Kinds) uint8_t const* tiles) {
+			size_t smaller[Kinds] = {};
+			size_t larger[Kinds] = {};
+			neighbors(tiles, size, smaller, larger);
+
+			double total = 0;
+			for (size_t k = 0; k < Kinds; ++k) {
+				if (larger[k] != npos)
+					total += (Bag.caps[k] - tiles[k]) * static_cast<double>(
+						expected[larger[k]]);
+			}
+
+			expected[number] = static_cast<float>(total / (Bag.bag - size));
+		});
+	}
+
+	float baseline = expected[0];
+	for (float& value : expected)
+		value -= baseline;
+
+	this->values = Table<float>(std::move(expected));
+}
+
+/**
+ * Opens an image in place
+ *
+ * The image is checked against the bag this build numbers racks by. A block
+ * that is not suitably aligned is copied first.
+ *
+ * @param data is the start of the image
+ * @param size is the length of the image in bytes
+ * @param storage optionally keeps the memory behind the image alive
+ * @return table viewing the image, or an empty table if the image is not
+ *         valid or was written by another version
+ */
+LeaveTable LeaveTable::open(_In_reads_(size) char const* data,
+	_In_ size_t size, _In_opt_ std::shared_ptr<void const> storage) {
+	Header header = {};
+	size_t count = Bag.offsets[Sizes];
+	if (size < sizeof(Header) + count * sizeof(float))
+		return {};
+
+	memcpy(&header, data, sizeof(header));
+	if (memcmp(header.magic, Magic, sizeof(Magic)) != 0
+		|| header.version != Version || header.rackSize != RackSize
+		|| memcmp(header.caps, Bag.caps, Kinds) != 0
+		|| header.count != count)
+		return {};
+
+	if (reinterpret_cast<uintptr_t>(data) % alignof(float)) {
+		auto copy = std::make_shared<std::vector<float>>(count);
+		memcpy(copy->data(), data + sizeof(Header), count * sizeof(float));
+		data = reinterpret_cast<char const*>(copy->data()) - sizeof(Header);
+		storage = std::move(copy);
+	}
+
+	LeaveTable table;
+	table.values = Table<float>(
+		reinterpret_cast<float const*>(data + sizeof(Header)), count);
+	table.storage = std::move(storage);
+	return table;
+}
+
+/**
+ * Writes the image of the table
+ *
+ * @return bytes of the image
+ */
+std::vector<char> LeaveTable::compile() const {
+	Header header = {};
+	memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	header.rackSize = RackSize;
+	memcpy(header.caps, Bag.caps, Kinds);
+	header.count = values.size();
+
+	std::vector<char> image(sizeof(Header) + values.size() * sizeof(float));
+	memcpy(image.data(), &header, sizeof(header));
+	memcpy(image.data() + sizeof(Header), values.data(),
+		values.size() * sizeof(float));
+	return image;
+}
+
+/**
+ * Looks up the number of a leave
+ *
+ * @param leave is the histogram of the tiles kept
+ * @return number of the leave, or npos if it holds more than RackSize tiles
+ *         or more of a tile than a bag does
+ */
+size_t LeaveTable::find(_In_ Rack const& leave) const {
+	if (leave.blanks < 0 || leave.blanks > Bag.caps[Blank])
+		return npos;
+
+	uint8_t tiles[Kinds] = {};
+	memcpy(tiles, leave.counts, Blank);
+	tiles[Blank] = static_cast<uint8_t>(leave.blanks);
+	return rank(tiles);
+}
+
+/**
+ * @param number is the number of a leave
+ * @return histogram of the leave
+ */
+Rack LeaveTable::leave(_In_ size_t number) const {
+	uint8_t tiles[Kinds] = {};
+	unrank(number, tiles);
+
+	Rack rack = {};
+	memcpy(rack.counts, tiles, Blank);
+	rack.blanks = tiles[Blank];
+	return rack;
+}
+
+/**
+ * @param leave is the histogram of the tiles kept
+ * @return value of the leave, or zero if it is not in the table
+ */
+float LeaveTable::value(_In_ Rack const& leave) const {
+	size_t number = find(leave);
+	return number < values.size() ? values[number] : 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Precomputed values of every rack leave
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <sal.h>
+
+#include "Rack.h"
+#include "Table.h"
+#include "WordIndex.h"
+
+/**
+ * Value of keeping each set of tiles on the rack after a play
+ *
+ * Every rack of up to seven tiles that a full English bag can hold has a
+ * number, counting from the empty rack through the racks of one tile and
+ * so on, and in the order of their letters within each size, with blanks
+ * last. Its value is the number of points that a rack refilled from it
+ * with random tiles from a full bag is expected to score, less what a rack
+ * drawn entirely at random is expected to score. A full rack scores the
+ * points of the best word that it spells, with the bingo bonus if the word
+ * uses every tile. The board is not considered, so the values only say how
+ * promising a leave is, not what it will score. Racks and bags are those of
+ * the classic alphabet, so a table is only built for and used with a
+ * lexicon spelled with it.
+ *
+ * A table can be written out as an image and mapped back in, in the byte
+ * order of the machine that wrote it.
+ */
+class LeaveTable {
+public:
+	/**
+	 * Format revision, which is bumped whenever the layout changes
+	 */
+	static constexpr uint32_t Version = 1;
+
+	/**
+	 * Number of tiles a rack holds
+	 */
+	static constexpr size_t RackSize = 7;
+
+	/**
+	 * Number returned for a rack that has no value in the table
+	 */
+	static constexpr size_t npos = SIZE_MAX;
+
+	LeaveTable() = default;
+
+	/**
+	 * Computes the value of every leave
+	 *
+	 * @param index is the letter count index of the words that can be
+	 *        played
+	 */
+	explicit LeaveTable(_In_ WordIndex const& index);
+
+	/**
+	 * Opens an image in place
+	 *
+	 * @param data is the start of the image
+	 * @param size is the length of the image in bytes
+	 * @param storage optionally keeps the memory behind the image alive
+	 * @return table viewing the image, or an empty table if the image is not
+	 *         valid or was written by another version
+	 */
+	static LeaveTable open(_In_reads_(size) char const* data,
+		_In_ size_t size,
+		_In_opt_ std::shared_ptr<void const> storage = nullptr);
+
+	/**
+	 * Writes the image of the table
+	 *
+	 * @return bytes of the image
+	 */
+	std::vector<char> compile() const;
+
+	/**
+	 * @return true if the table holds no values
+	 */
+	bool empty() const {
+		return values.size() == 0;
+	}
+
+	/**
+	 * @return number of leaves in the table
+	 */
+	size_t size() const {
+		return values.size();
+	}
+
+	/**
+	 * Looks up the number of a leave
+	 *
+	 * @param leave is the histogram of the tiles kept
+	 * @return number of the leave, or npos if it holds more than RackSize
+	 *         tiles or more of a tile than a bag does
+	 */
+	size_t find(_In_ Rack const& leave) const;
+
+	/**
+	 * @param number is the number of a leave
+	 * @return histogram of the leave
+	 */
+	Rack leave(_In_ size_t number) const;
+
+	/**
+	 * @param number is the number of a leave
+	 * @return value of the leave
+	 */
+	float value(_In_ size_t number) const {
+		return values[number];
+	}
+
+	/**
+	 * @param leave is the histogram of the tiles kept
+	 * @return value of the leave, or zero if it is not in the table
+	 */
+	float value(_In_ Rack const& leave) const;
+
+private:
+	Table<float> values;
+	std::shared_ptr<void const> storage;
+};
@@ -0,0 +1,137 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Dictionary together with every index built from it
+ */
+
+#include "Lexicon.h"
+
+#include <utility>
+
+/**
+ * Builds every index for a dictionary
+ *
+ * @param dictionary is the word list to index
+ */
+Lexicon::Lexicon(_In_ Dictionary dictionary) :
+	Lexicon(std::move(dictionary), false) {
+}
+
+/**
+ * Builds the letter count index for a dictionary, and optionally the others
+ *
+ * @param dictionary is the word list to index
+ * @param deferred is true to leave every other index to build()
+ */
+Lexicon::Lexicon(_In_ Dictionary dictionary, _In_ bool deferred) :
+	Lexicon(std::move(dictionary), Alphabet(), deferred) {
+}
+
+/**
+ * Maps a dictionary onto the tiles of an alphabet and builds the letter
+ * count index for it, and optionally the others
+ *
+ * The classic alphabet keeps the dictionary as it is.
+ *
+ * @param dictionary is the word list to index, in UTF-8
+ * @param alphabet holds the tiles the words are spelled with
+ * @param deferred is true to leave every other index to build()
+ */
+Lexicon::Lexicon(_In_ Dictionary dictionary, _In_ Alphabet alphabet,
+	_In_ bool deferred) : tiles(std::move(alphabet)),
+	words(tiles.transcode(dictionary)), counts(words, tiles) {
+	if (!deferred) {
+		anagrams = SignatureIndex(counts);
+		graph = Dawg(words);
+		fragments = SubstringIndex(words);
+		postings = BitsetIndex(counts);
+		return;
+	}
+
+	this->deferred->signatures = false;
+	this->deferred->dawg = false;
+	this->deferred->substrings = false;
+	this->deferred->bitsets = false;
+}
+
+/**
+ * Gets the GADDAG of the dictionary, building it on first use
+ *
+ * @return bidirectional word graph of the dictionary
+ */
+Gaddag const& Lexicon::gaddag() const {
+	std::call_once(deferred->once, [this] {
+		deferred->graph = Gaddag(words);
+		deferred->built.store(true, std::memory_order_release);
+	});
+	return deferred->graph;
+}
+
+/**
+ * Checks whether the index an engine searches has been built
+ *
+ * @param engine is the engine to check
+ * @return true if the engine can be used
+ */
+bool Lexicon::ready(_In_ Engine engine) const {
+	switch (engine) {
+		case Engine::Signature:
+			return deferred->signatures.load(std::memory_order_acquire);
+		case Engine::Dawg:
+		case Engine::Gaddag:
+			return deferred->dawg.load(std::memory_order_acquire);
+		case Engine::Substring:
+			return deferred->substrings.load(std::memory_order_acquire);
+		case Engine::Bitset:
+			return deferred->bitsets.load(std::memory_order_acquire);
+		default:
+			return true;
+	}
+}
+
+/**
+ * @return number of indexes that have not been built yet
+ */
+size_t Lexicon::missing() const {
+	size_t count = 0;
+	for (Engine engine : { Engine::Signature, Engine::Dawg, Engine::Substring,
+		Engine::Bitset })
+		count += ready(engine) ? 0 : 1;
+
+	return count;
+}
+
+/**
+ * Builds the index an engine searches if it has not been built yet
+ *
+ * Each index is built to the side and only moved into place once done, and
+ * its flag is set afterwards, so a query never sees it half built.
+ *
+ * @param engine is the signature, word graph, substring or bitset engine
+ */
+void Lexicon::build(_In_ Engine engine) {
+	if (ready(engine))
+		return;
+
+	switch (engine) {
+		case Engine::Signature:
+			anagrams = SignatureIndex(counts);
+			deferred->signatures.store(true, std::memory_order_release);
+			break;
+		case Engine::Dawg:
+			graph = Dawg(words);
+			deferred->dawg.store(true, std::memory_order_release);
+			break;
+		case Engine::Substring:
+			fragments = SubstringIndex(words);
+			deferred->substrings.store(true, std::memory_order_release);
+			break;
+		case Engine::Bitset:
+			postings = BitsetIndex(counts);
+			deferred->bitsets.store(true, std::memory_order_release);
+			break;
+		default:
+			break;
+	}
+}
@@ -0,0 +1,202 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Dictionary together with every index built from it
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include <sal.h>
+
+#include "Alphabet.h"
+#include "BitsetIndex.h"
+#include "Dawg.h"
+#include "Dictionary.h"
+#include "Gaddag.h"
+#include "Query.h"
+#include "SignatureIndex.h"
+#include "SubstringIndex.h"
+#include "WordIndex.h"
+
+/**
+ * Word list and its indexes, built once and shared by every query
+ *
+ * The GADDAG is the exception: it costs far more memory than the other
+ * indexes and only helps searches that start inside a word, so it is built
+ * the first time it is asked for.
+ *
+ * A lexicon can also start out with only its letter count index, which is
+ * all a scan needs, and have the others built afterwards, each on its own
+ * thread if wanted. Until an index is ready, the engine that uses it must
+ * not be asked for, and the lexicon must not be moved while any index is
+ * being built. A lexicon cannot be copied, since the flags that say which
+ * indexes are ready are shared with anything that holds them, while the
+ * indexes themselves are not.
+ *
+ * The words are indexed as tile codes of an alphabet, which is the classic
+ * one unless another is given, so queries have to be mapped onto it before
+ * they are solved and the words found mapped back before they are shown.
+ */
+class Lexicon {
+public:
+	Lexicon() = default;
+
+	/**
+	 * Builds every index for a dictionary
+	 *
+	 * @param dictionary is the word list to index
+	 */
+	explicit Lexicon(_In_ Dictionary dictionary);
+
+	/**
+	 * Builds the letter count index for a dictionary, and optionally the
+	 * others
+	 *
+	 * @param dictionary is the word list to index
+	 * @param deferred is true to leave every other index to build()
+	 */
+	Lexicon(_In_ Dictionary dictionary, _In_ bool deferred);
+
+	/**
+	 * Maps a dictionary onto the tiles of an alphabet and builds the letter
+	 * count index for it, and optionally the others
+	 *
+	 * @param dictionary is the word list to index, in UTF-8
+	 * @param alphabet holds the tiles the words are spelled with
+	 * @param deferred is true to leave every other index to build()
+	 */
+	Lexicon(_In_ Dictionary dictionary, _In_ Alphabet alphabet,
+		_In_ bool deferred = false);
+
+	Lexicon(Lexicon const&) = delete;
+	Lexicon(Lexicon&&) = default;
+	Lexicon& operator=(Lexicon const&) = delete;
+	Lexicon& operator=(Lexicon&&) = default;
+
+	/**
+	 * @return tiles the words are spelled with
+	 */
+	Alphabet const& alphabet() const {
+		return tiles;
+	}
+
+	/**
+	 * @return word list the indexes were built from
+	 */
+	Dictionary const& dictionary() const {
+		return words;
+	}
+
+	/**
+	 * @return letter count index of the dictionary
+	 */
+	WordIndex const& index() const {
+		return counts;
+	}
+
+	/**
+	 * @return anagram signature index of the dictionary
+	 */
+	SignatureIndex const& signatures() const {
+		return anagrams;
+	}
+
+	/**
+	 * @return word graph of the dictionary
+	 */
+	Dawg const& dawg() const {
+		return graph;
+	}
+
+	/**
+	 * @return suffix and substring index of the dictionary
+	 */
+	SubstringIndex const& substrings() const {
+		return fragments;
+	}
+
+	/**
+	 * @return letter and tile count posting lists of the dictionary
+	 */
+	BitsetIndex const& bitsets() const {
+		return postings;
+	}
+
+	/**
+	 * Gets the GADDAG of the dictionary, building it on first use
+	 *
+	 * Callers that ask while it is being built wait for the same build.
+	 *
+	 * @return bidirectional word graph of the dictionary
+	 */
+	Gaddag const& gaddag() const;
+
+	/**
+	 * @return true if the GADDAG has already been built, so asking for it
+	 *         costs nothing
+	 */
+	bool hasGaddag() const {
+		return deferred->built.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * Checks whether the index an engine searches has been built
+	 *
+	 * The scan only needs the letter count index, which is always there.
+	 * The GADDAG engine also looks words up in the word graph, so it is
+	 * ready with the word graph, and builds the GADDAG itself when first
+	 * used.
+	 *
+	 * @param engine is the engine to check
+	 * @return true if the engine can be used
+	 */
+	bool ready(_In_ Engine engine) const;
+
+	/**
+	 * @return number of indexes that have not been built yet
+	 */
+	size_t missing() const;
+
+	/**
+	 * Builds the index an engine searches if it has not been built yet
+	 *
+	 * Queries may use the lexicon while this runs, and different indexes
+	 * may be built at the same time from different threads. The GADDAG is
+	 * not built by this, as it is always built on first use.
+	 *
+	 * @param engine is the signature, word graph, substring or bitset
+	 *        engine
+	 */
+	void build(_In_ Engine engine);
+
+private:
+	friend class LexiconImage;
+
+	/**
+	 * Indexes that are built after the lexicon is made, with flags that are
+	 * set once each is ready
+	 */
+	struct Deferred {
+		std::once_flag once;
+		std::atomic<bool> built{ false };
+		Gaddag graph;
+		std::atomic<bool> signatures{ true };
+		std::atomic<bool> dawg{ true };
+		std::atomic<bool> substrings{ true };
+		std::atomic<bool> bitsets{ true };
+	};
+
+	Alphabet tiles;
+	Dictionary words;
+	WordIndex counts;
+	SignatureIndex anagrams;
+	Dawg graph;
+	SubstringIndex fragments;
+	BitsetIndex postings;
+	std::shared_ptr<Deferred> deferred = std::make_shared<Deferred>();
+};
@@ -0,0 +1,323 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Precompiled binary form of a lexicon that is used in place
+ */
+
+#include "LexiconImage.h"
+
+#include <cstring>
+#include <string>
+#include <utility>
+
+namespace {
+	/**
+	 * Arrays stored in an image, in the order of the section table
+	 */
+	enum Part : size_t {
+		Text, Entries, Histograms, Scores, Lengths, SignatureWords,
+		SignatureBuckets, DawgNodes, DawgEdges, DawgOrder, SuffixOrder,
+		PairOffsets, PairPostings, BitsetContainers, BitsetBitmaps,
+		BitsetArrays, AlphabetText, PartCount
+	};
+
+	/**
+	 * Fixed-size start of an image
+	 */
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t sections;
+		uint64_t size;
+		uint64_t checksum;
+		uint64_t mask;
+		int32_t longest;
+		uint32_t flags;
+	};
+
+	/**
+	 * Location and element size of one array inside of an image
+	 */
+	struct Section {
+		uint64_t offset;
+		uint64_t count;
+		uint32_t stride;
+		uint32_t reserved;
+	};
+
+	/**
+	 * Header flag set when the dictionary's words are in ascending order
+	 */
+	constexpr uint32_t Sorted = 1;
+
+	constexpr char Magic[8] = { 'S', 'C', 'R', 'A', 'B', 'L', 'E', 'X' };
+	constexpr size_t Alignment = 8;
+	constexpr size_t Preamble = sizeof(Header) + sizeof(Section) * PartCount;
+
+	static_assert(Preamble % Alignment == 0,
+		"sections must start on an aligned boundary");
+
+	/**
+	 * Hashes a block eight bytes at a time
+	 *
+	 * @param data is the start of the block
+	 * @param size is the length of the block, a multiple of eight bytes
+	 * @return checksum of the block
+	 */
+	uint64_t checksum(_In_reads_(size) char const* data, _In_ size_t size) {
+		uint64_t result = 0xCBF29CE484222325ull;
+		for (size_t i = 0; i + sizeof(uint64_t) <= size;
+			i += sizeof(uint64_t)) {
+			uint64_t word = 0;
+			memcpy(&word, data + i, sizeof(word));
+			result = (result ^ word) * 0x100000001B3ull;
+			result ^= result >> 29;
+		}
+
+		return result;
+	}
+
+	/**
+	 * Appends an array to an image as a new section
+	 *
+	 * @param image is the image being written
+	 * @param section receives the location of the array
+	 * @param values are the elements to append
+	 */
+	template <typename T>
+	void append(_Inout_ std::vector<char>& image, _Out_ Section& section,
+		_In_ Table<T> const& values) {
+		section = { image.size(), values.size(), sizeof(T), 0 };
+		char const* bytes = reinterpret_cast<char const*>(values.data());
+		image.insert(image.end(), bytes, bytes + values.size() * sizeof(T));
+		image.resize((image.size() + Alignment - 1) / Alignment * Alignment);
+	}
+
+	/**
+	 * Points a table at one section of an image
+	 *
+	 * @param image is the start of the image
+	 * @param size is the length of the image in bytes
+	 * @param section is the location of the array
+	 * @param values receives a view of the array
+	 * @return false if the section does not fit the image or holds elements
+	 *         of a different size
+	 */
+	template <typename T>
+	bool view(_In_ char const* image, _In_ uint64_t size,
+		_In_ Section const& section, _Out_ Table<T>& values) {
+		if (section.stride != sizeof(T) || section.offset < Preamble
+			|| section.offset % Alignment || section.offset > size
+			|| section.count > (size - section.offset) / sizeof(T))
+			return false;
+
+		values = Table<T>(reinterpret_cast<T const*>(image + section.offset),
+			static_cast<size_t>(section.count));
+		return true;
+	}
+
+	/**
+	 * Checks that every word of a dictionary lies within its text
+	 *
+	 * @param entries are the offsets and lengths of the words
+	 * @param size is the length of the text
+	 * @return true if every word can be read safely
+	 */
+	bool within(_In_ Table<Dictionary::Entry> const& entries,
+		_In_ size_t size) {
+		for (Dictionary::Entry const& entry : entries) {
+			if (entry.offset > size || entry.length > size - entry.offset)
+				return false;
+		}
+
+		return true;
+	}
+}
+
+/**
+ * Writes the image of a lexicon
+ *
+ * The words are packed into a single block of text without separators, and
+ * the dictionary's entries are rewritten to point into it.
+ *
+ * @param lexicon is the word list and indexes to serialize
+ * @return bytes of the image
+ */
+std::vector<char> LexiconImage::compile(_In_ Lexicon const& lexicon) {
+	Dictionary const& dictionary = lexicon.words;
+	std::string text;
+	std::vector<Dictionary::Entry> entries(dictionary.size());
+	for (size_t i = 0; i < dictionary.size(); ++i) {
+		std::string_view word = dictionary[i];
+		entries[i] = { static_cast<uint32_t>(text.size()),
+			static_cast<uint32_t>(word.length()) };
+		text.append(word);
+	}
+
+	Header header = {};
+	memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	header.sections = PartCount;
+	header.mask = lexicon.anagrams.mask;
+	header.longest = lexicon.anagrams.longest;
+	header.flags = dictionary.sorted() ? Sorted : 0;
+
+	Section sections[PartCount] = {};
+	std::vector<char> image(Preamble);
+	append(image, sections[Text], Table<char>(text.data(), text.size()));
+	append(image, sections[Entries], Table<Dictionary::Entry>(
+		std::move(entries)));
+	append(image, sections[Histograms], lexicon.counts.histograms);
+	append(image, sections[Scores], lexicon.counts.scores);
+	append(image, sections[Lengths], lexicon.counts.lengths);
+	append(image, sections[SignatureWords], lexicon.anagrams.words);
+	append(image, sections[SignatureBuckets], lexicon.anagrams.buckets);
+	append(image, sections[DawgNodes], lexicon.graph.nodes);
+	append(image, sections[DawgEdges], lexicon.graph.edges);
+	append(image, sections[DawgOrder], lexicon.graph.order);
+	append(image, sections[SuffixOrder], lexicon.fragments.reversed);
+	append(image, sections[PairOffsets], lexicon.fragments.offsets);
+	append(image, sections[PairPostings], lexicon.fragments.postings);
+	append(image, sections[BitsetContainers], lexicon.postings.containers);
+	append(image, sections[BitsetBitmaps], lexicon.postings.bitmaps);
+	append(image, sections[BitsetArrays], lexicon.postings.arrays);
+	std::string description = lexicon.tiles.describe();
+	append(image, sections[AlphabetText],
+		Table<char>(description.data(), description.size()));
+
+	memcpy(image.data() + sizeof(Header), sections, sizeof(sections));
+	header.size = image.size();
+	header.checksum = checksum(image.data() + sizeof(Header),
+		image.size() - sizeof(Header));
+	memcpy(image.data(), &header, sizeof(header));
+	return image;
+}
+
+/**
+ * Checks whether a block of memory starts like an image
+ *
+ * @param data is the start of the block
+ * @param size is the length of the block in bytes
+ * @return true if the block begins with the image signature
+ */
+bool LexiconImage::recognizes(_In_reads_(size) char const* data,
+	_In_ size_t size) {
+	return size >= sizeof(Header) && memcmp(data, Magic, sizeof(Magic)) == 0;
+}
+
+/**
+ * Opens an image in place
+ *
+ * Besides the bounds of every section, the sizes of the arrays are checked
+ * against each other, which catches an image from a mismatched build even
+ * when the checksum is skipped. A verified image also has every value that
+ * indexes another array checked in one pass over it, since the checksum
+ * only catches damage and not an image that was written to be malformed.
+ *
+ * @param data is the start of the image
+ * @param size is the length of the image in bytes
+ * @param storage optionally keeps the memory behind the image alive
+ * @param verify is true to check the checksum and every value that indexes
+ *        another array
+ * @return lexicon viewing the image, or an empty lexicon if the image is
+ *         not valid or was written by another version
+ */
+Lexicon LexiconImage::open(_In_reads_(size) char const* data,
+	_In_ size_t size, _In_opt_ std::shared_ptr<void const> storage,
+	_In_ bool verify) {
+	if (!recognizes(data, size) || size < Preamble)
+		return {};
+
+	if (reinterpret_cast<uintptr_t>(data) % Alignment) {
+		auto copy = std::make_shared<std::vector<uint64_t>>(
+			(size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+		memcpy(copy->data(), data, size);
+		data = reinterpret_cast<char const*>(copy->data());
+		storage = std::move(copy);
+	}
+
+	Header header = {};
+	memcpy(&header, data, sizeof(header));
+	if (header.version != Version || header.sections != PartCount
+		|| header.size > size || header.size < Preamble
+		|| header.size % Alignment)
+		return {};
+
+	if (verify && checksum(data + sizeof(Header),
+		static_cast<size_t>(header.size) - sizeof(Header))
+		!= header.checksum)
+		return {};
+
+	Section sections[PartCount] = {};
+	memcpy(sections, data + sizeof(Header), sizeof(sections));
+
+	Lexicon lexicon;
+	Table<char> text;
+	Table<char> description;
+	Dictionary& dictionary = lexicon.words;
+	WordIndex& counts = lexicon.counts;
+	SignatureIndex& anagrams = lexicon.anagrams;
+	Dawg& graph = lexicon.graph;
+	SubstringIndex& fragments = lexicon.fragments;
+	BitsetIndex& postings = lexicon.postings;
+	if (!view(data, header.size, sections[Text], text)
+		|| !view(data, header.size, sections[Entries], dictionary.entries)
+		|| !view(data, header.size, sections[Histograms], counts.histograms)
+		|| !view(data, header.size, sections[Scores], counts.scores)
+		|| !view(data, header.size, sections[Lengths], counts.lengths)
+		|| !view(data, header.size, sections[SignatureWords], anagrams.words)
+		|| !view(data, header.size, sections[SignatureBuckets],
+			anagrams.buckets)
+		|| !view(data, header.size, sections[DawgNodes], graph.nodes)
+		|| !view(data, header.size, sections[DawgEdges], graph.edges)
+		|| !view(data, header.size, sections[DawgOrder], graph.order)
+		|| !view(data, header.size, sections[SuffixOrder],
+			fragments.reversed)
+		|| !view(data, header.size, sections[PairOffsets], fragments.offsets)
+		|| !view(data, header.size, sections[PairPostings],
+			fragments.postings)
+		|| !view(data, header.size, sections[BitsetContainers],
+			postings.containers)
+		|| !view(data, header.size, sections[BitsetBitmaps], postings.bitmaps)
+		|| !view(data, header.size, sections[BitsetArrays], postings.arrays)
+		|| !view(data, header.size, sections[AlphabetText], description))
+		return {};
+
+	Alphabet alphabet = Alphabet::parse(
+		std::string_view(description.data(), description.size()));
+	if (alphabet.empty())
+		return {};
+
+	size_t words = dictionary.entries.size();
+	postings.words = words;
+	bool consistent = counts.histograms.size() == words * WordIndex::Stride
+		&& counts.scores.size() == words && counts.lengths.size() == words
+		&& anagrams.words.size() == words
+		&& anagrams.buckets.size() == header.mask + 1
+		&& (anagrams.buckets.size() & header.mask) == 0
+		&& (graph.order.empty() || graph.order.size() <= words)
+		&& fragments.reversed.size() == words
+		&& fragments.offsets.size()
+			== Alphabet::MaxTiles * Alphabet::MaxTiles + 1
+		&& fragments.postings.size() == fragments.offsets.back()
+		&& postings.intact()
+		&& (graph.nodes.empty() == (words == 0));
+	if (!consistent)
+		return {};
+
+	if (verify && (!within(dictionary.entries, text.size())
+		|| !graph.intact(words) || !anagrams.intact(words)
+		|| !fragments.intact(words)))
+		return {};
+
+	dictionary.data = text.data();
+	dictionary.ascending = (header.flags & Sorted) != 0;
+	dictionary.storage = std::move(storage);
+	anagrams.mask = static_cast<size_t>(header.mask);
+	anagrams.longest = header.longest;
+	counts.adopt(alphabet);
+	anagrams.tileCount = alphabet.size();
+	lexicon.tiles = std::move(alphabet);
+	return lexicon;
+}
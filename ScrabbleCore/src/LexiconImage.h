@@ -0,0 +1,78 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Precompiled binary form of a lexicon that is used in place
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <sal.h>
+
+#include "Lexicon.h"
+
+/**
+ * Serializes a lexicon and its indexes into a single versioned block
+ *
+ * The image starts with a header and a table of sections, followed by the
+ * word text and every array of every index, each aligned to eight bytes.
+ * The alphabet the words are spelled with is stored as its description.
+ * Opening an image checks the header and the section table, then points the
+ * tables of a lexicon straight into the block, so nothing is parsed, copied
+ * or rebuilt and the operating system only pages in the parts that queries
+ * touch. A checksum over everything after the header guards against
+ * truncated or corrupted files. Images are written in the byte order and
+ * structure layout of the machine that compiled them.
+ */
+class LexiconImage {
+public:
+	/**
+	 * Format revision, which is bumped whenever the layout changes
+	 */
+	static constexpr uint32_t Version = 3;
+
+	/**
+	 * Writes the image of a lexicon
+	 *
+	 * @param lexicon is the word list and indexes to serialize
+	 * @return bytes of the image
+	 */
+	static std::vector<char> compile(_In_ Lexicon const& lexicon);
+
+	/**
+	 * Checks whether a block of memory starts like an image
+	 *
+	 * @param data is the start of the block
+	 * @param size is the length of the block in bytes
+	 * @return true if the block begins with the image signature
+	 */
+	static bool recognizes(_In_reads_(size) char const* data,
+		_In_ size_t size);
+
+	/**
+	 * Opens an image in place
+	 *
+	 * The block must remain valid for as long as the lexicon is used, which
+	 * can be ensured by passing the object that owns it as the storage. A
+	 * block that is not suitably aligned is copied first. Skipping the
+	 * checksum and the checks of the values avoids reading the whole image
+	 * up front, which is safe when the block cannot have been altered, such
+	 * as a resource of the running executable.
+	 *
+	 * @param data is the start of the image
+	 * @param size is the length of the image in bytes
+	 * @param storage optionally keeps the memory behind the image alive
+	 * @param verify is true to check the checksum and every value that
+	 *        indexes another array
+	 * @return lexicon viewing the image, or an empty lexicon if the image is
+	 *         not valid or was written by another version
+	 */
+	static Lexicon open(_In_reads_(size) char const* data, _In_ size_t size,
+		_In_opt_ std::shared_ptr<void const> storage = nullptr,
+		_In_ bool verify = true);
+};
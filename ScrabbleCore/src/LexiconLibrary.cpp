@@ -0,0 +1,282 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Set of lexicons that are loaded in the background on first use
+ */
+
+#include "LexiconLibrary.h"
+
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+#include "DictionaryLoader.h"
+
+/**
+ * Starts the loader thread
+ *
+ * @param loaded is called with the identifier of every lexicon that
+ *        finishes loading or fails to load, and again each time one of its
+ *        indexes is built, from the thread that did the work
+ */
+LexiconLibrary::LexiconLibrary(_In_opt_ Notification loaded) :
+	loaded(std::move(loaded)), thread(&LexiconLibrary::work, this) {
+}
+
+/**
+ * Drops any queued loads and joins the loader thread
+ *
+ * Index builders are only started by the loader thread, so once it has
+ * stopped, no more can appear and they can be joined without the lock.
+ */
+LexiconLibrary::~LexiconLibrary() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+		queue.clear();
+	}
+
+	wake.notify_one();
+	thread.join();
+	for (std::thread& builder : builders)
+		builder.join();
+}
+
+/**
+ * Registers an external dictionary file
+ *
+ * Paths are made absolute before they are compared, so the same file given
+ * relative to the working directory and in full is only registered once.
+ *
+ * @param name is the name shown for the lexicon
+ * @param path is the location of the compiled image or word list
+ * @return identifier of the lexicon, which is the existing one if the path
+ *         was already registered
+ */
+size_t LexiconLibrary::add(_In_ std::wstring name, _In_ std::wstring path) {
+	std::error_code error;
+	std::filesystem::path absolute = std::filesystem::absolute(path, error);
+	if (!error)
+		path = absolute.lexically_normal().wstring();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	for (size_t id = 0; id < entries.size(); ++id) {
+		if (!entries[id].module && entries[id].path == path)
+			return id;
+	}
+
+	Entry entry;
+	entry.name = std::move(name);
+	entry.path = std::move(path);
+	entries.push_back(std::move(entry));
+	return entries.size() - 1;
+}
+
+/**
+ * Registers a lexicon embedded as a resource of a module
+ *
+ * @param name is the name shown for the lexicon
+ * @param module is the handle of the module holding the resource
+ * @param resource is the identifier of the resource
+ * @return identifier of the lexicon, which is the existing one if the
+ *         resource was already registered
+ */
+size_t LexiconLibrary::add(_In_ std::wstring name, _In_ void* module,
+	_In_ int resource) {
+	std::lock_guard<std::mutex> lock(mutex);
+	for (size_t id = 0; id < entries.size(); ++id) {
+		if (entries[id].module == module && entries[id].resource == resource)
+			return id;
+	}
+
+	Entry entry;
+	entry.name = std::move(name);
+	entry.module = module;
+	entry.resource = resource;
+	entries.push_back(std::move(entry));
+	return entries.size() - 1;
+}
+
+/**
+ * @return number of registered lexicons
+ */
+size_t LexiconLibrary::size() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return entries.size();
+}
+
+/**
+ * @param id is the identifier of the lexicon
+ * @return name shown for the lexicon
+ */
+std::wstring LexiconLibrary::name(_In_ size_t id) const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return entries[id].name;
+}
+
+/**
+ * @param id is the identifier of the lexicon
+ * @return progress of the lexicon
+ */
+LexiconState LexiconLibrary::state(_In_ size_t id) const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return entries[id].state;
+}
+
+/**
+ * @param id is the identifier of the lexicon
+ * @return time spent loading and indexing the lexicon so far
+ */
+Profile LexiconLibrary::profile(_In_ size_t id) const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return entries[id].loading;
+}
+
+/**
+ * Gets a lexicon, starting to load it if this is its first use
+ *
+ * @param id is the identifier of the lexicon
+ * @return lexicon, or nullptr if it is not ready yet or failed to load
+ */
+std::shared_ptr<Lexicon const> LexiconLibrary::acquire(_In_ size_t id) {
+	std::shared_ptr<Lexicon const> lexicon;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		lexicon = request(id);
+	}
+
+	wake.notify_one();
+	return lexicon;
+}
+
+/**
+ * Gets a lexicon, waiting for it to load if needed
+ *
+ * @param id is the identifier of the lexicon
+ * @return lexicon, which may still be indexing, or nullptr if it failed to
+ *         load
+ */
+std::shared_ptr<Lexicon const> LexiconLibrary::wait(_In_ size_t id) {
+	std::unique_lock<std::mutex> lock(mutex);
+	request(id);
+	wake.notify_one();
+	finished.wait(lock, [this, id] {
+		LexiconState state = entries[id].state;
+		return state == LexiconState::Indexing
+			|| state == LexiconState::Ready || state == LexiconState::Failed;
+	});
+	return entries[id].lexicon;
+}
+
+/**
+ * Queues a lexicon for loading if it has not been asked for before
+ *
+ * Must be called with the lock held.
+ *
+ * @param id is the identifier of the lexicon
+ * @return lexicon, or nullptr if it is not ready yet or failed to load
+ */
+std::shared_ptr<Lexicon const> LexiconLibrary::request(_In_ size_t id) {
+	Entry& entry = entries[id];
+	if (entry.state == LexiconState::Unloaded) {
+		entry.state = LexiconState::Loading;
+		queue.push_back(id);
+	}
+
+	return entry.lexicon;
+}
+
+/**
+ * Loads queued lexicons until the library is destroyed
+ *
+ * Loading runs without the lock held, so lexicons that are already loaded
+ * can be acquired and new ones registered in the meantime. A word list is
+ * handed out as soon as it can be scanned, and a builder thread is started
+ * for each of its other indexes.
+ */
+void LexiconLibrary::work() {
+	while (true) {
+		size_t id = 0;
+		std::wstring path;
+		void* module = nullptr;
+		int resource = 0;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this] {
+				return stopping || !queue.empty();
+			});
+			if (stopping)
+				return;
+
+			id = queue.front();
+			queue.pop_front();
+			path = entries[id].path;
+			module = entries[id].module;
+			resource = entries[id].resource;
+		}
+
+		Profile loading;
+		std::shared_ptr<Lexicon> lexicon;
+		{
+			ScopedTimer timer(&loading, Stage::Load);
+			lexicon = std::make_shared<Lexicon>(module
+				? loadLexicon(module, resource, true)
+				: loadLexicon(path.c_str(), true));
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			Entry& entry = entries[id];
+			entry.loading = loading;
+			if (lexicon->dictionary().empty()) {
+				entry.state = LexiconState::Failed;
+			} else {
+				entry.state = lexicon->missing() ? LexiconState::Indexing
+					: LexiconState::Ready;
+				entry.lexicon = lexicon;
+				for (Engine engine : { Engine::Signature, Engine::Dawg,
+					Engine::Substring, Engine::Bitset }) {
+					if (!lexicon->ready(engine))
+						builders.emplace_back(&LexiconLibrary::index, this, id,
+							lexicon, engine);
+				}
+			}
+		}
+
+		finished.notify_all();
+		if (loaded)
+			loaded(id);
+	}
+}
+
+/**
+ * Builds one index of a lexicon that is already being searched
+ *
+ * The lexicon becomes ready once the last of its indexes is built, by
+ * whichever builder finishes last.
+ *
+ * @param id is the identifier of the lexicon
+ * @param lexicon is the lexicon to index, which the builder keeps alive
+ * @param engine is the engine whose index is built
+ */
+void LexiconLibrary::index(_In_ size_t id,
+	_In_ std::shared_ptr<Lexicon> lexicon, _In_ Engine engine) {
+	Profile building;
+	{
+		ScopedTimer timer(&building, Stage::Index);
+		lexicon->build(engine);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		Entry& entry = entries[id];
+		entry.loading.merge(building);
+		if (!lexicon->missing())
+			entry.state = LexiconState::Ready;
+	}
+
+	finished.notify_all();
+	if (loaded)
+		loaded(id);
+}
@@ -0,0 +1,164 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Set of lexicons that are loaded in the background on first use
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sal.h>
+
+#include "Lexicon.h"
+#include "Trace.h"
+
+/**
+ * Progress of a lexicon in a library
+ *
+ * An indexing lexicon can already be searched, by whichever engines have
+ * their index built so far.
+ */
+enum class LexiconState : uint8_t {
+	Unloaded, Loading, Indexing, Ready, Failed
+};
+
+/**
+ * Registry of word lists, each mapped and indexed only once it is needed
+ *
+ * Registering a lexicon only records where it lives. The first time it is
+ * acquired, it is queued for a loader thread, which maps the file and either
+ * opens it in place as a compiled image or reads it as a word list, and the
+ * caller is notified once it can be searched. A word list first only gets
+ * the letter count index needed to scan it, and every other index is then
+ * built on a thread of its own, with the caller notified as each is done.
+ * Loaded lexicons stay resident and are shared with every caller, so
+ * switching between them is instant. The same file or resource registered
+ * twice is loaded only once, and compiled images stay backed by their
+ * files, so resident lexicons only take up memory for the pages that
+ * queries have touched.
+ */
+class LexiconLibrary {
+public:
+	using Notification = std::function<void(size_t)>;
+
+	/**
+	 * Starts the loader thread
+	 *
+	 * @param loaded is called with the identifier of every lexicon that
+	 *        finishes loading or fails to load, and again each time one of
+	 *        its indexes is built, from the thread that did the work
+	 */
+	explicit LexiconLibrary(_In_opt_ Notification loaded = nullptr);
+
+	LexiconLibrary(LexiconLibrary const&) = delete;
+	LexiconLibrary& operator=(LexiconLibrary const&) = delete;
+
+	/**
+	 * Drops any queued loads and joins the loader thread
+	 *
+	 * A load that is already running is finished first, as are indexes
+	 * that are being built.
+	 */
+	~LexiconLibrary();
+
+	/**
+	 * Registers an external dictionary file
+	 *
+	 * @param name is the name shown for the lexicon
+	 * @param path is the location of the compiled image or word list
+	 * @return identifier of the lexicon, which is the existing one if the
+	 *         path was already registered
+	 */
+	size_t add(_In_ std::wstring name, _In_ std::wstring path);
+
+	/**
+	 * Registers a lexicon embedded as a resource of a module
+	 *
+	 * @param name is the name shown for the lexicon
+	 * @param module is the handle of the module holding the resource
+	 * @param resource is the identifier of the resource
+	 * @return identifier of the lexicon, which is the existing one if the
+	 *         resource was already registered
+	 */
+	size_t add(_In_ std::wstring name, _In_ void* module, _In_ int resource);
+
+	/**
+	 * @return number of registered lexicons
+	 */
+	size_t size() const;
+
+	/**
+	 * @param id is the identifier of the lexicon
+	 * @return name shown for the lexicon
+	 */
+	std::wstring name(_In_ size_t id) const;
+
+	/**
+	 * @param id is the identifier of the lexicon
+	 * @return progress of the lexicon
+	 */
+	LexiconState state(_In_ size_t id) const;
+
+	/**
+	 * @param id is the identifier of the lexicon
+	 * @return time spent loading and indexing the lexicon so far
+	 */
+	Profile profile(_In_ size_t id) const;
+
+	/**
+	 * Gets a lexicon, starting to load it if this is its first use
+	 *
+	 * @param id is the identifier of the lexicon
+	 * @return lexicon, or nullptr if it is not ready yet or failed to load
+	 */
+	std::shared_ptr<Lexicon const> acquire(_In_ size_t id);
+
+	/**
+	 * Gets a lexicon, waiting for it to load if needed
+	 *
+	 * @param id is the identifier of the lexicon
+	 * @return lexicon, which may still be indexing, or nullptr if it failed
+	 *         to load
+	 */
+	std::shared_ptr<Lexicon const> wait(_In_ size_t id);
+
+private:
+	/**
+	 * Registered lexicon and where it is loaded from
+	 */
+	struct Entry {
+		std::wstring name;
+		std::wstring path;
+		void* module = nullptr;
+		int resource = 0;
+		LexiconState state = LexiconState::Unloaded;
+		std::shared_ptr<Lexicon const> lexicon;
+		Profile loading;
+	};
+
+	std::shared_ptr<Lexicon const> request(_In_ size_t id);
+	void work();
+	void index(_In_ size_t id, _In_ std::shared_ptr<Lexicon> lexicon,
+		_In_ Engine engine);
+
+	Notification loaded;
+	mutable std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable finished;
+	std::vector<Entry> entries;
+	std::deque<size_t> queue;
+	bool stopping = false;
+	std::thread thread;
+	std::vector<std::thread> builders;
+};
@@ -0,0 +1,60 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Read-only memory-mapped file
+ */
+
+#include "MappedFile.h"
+
+#include <windows.h>
+
+/**
+ * Maps a file into memory
+ *
+ * Opens the file for shared reading and maps a read-only view of its entire
+ * contents. Empty files cannot be mapped and are treated as a failure.
+ *
+ * @param path is the location of the file to map
+ * @return mapped file, or nullptr if the file could not be mapped
+ */
+std::shared_ptr<MappedFile> MappedFile::open(_In_ wchar_t const* path) {
+	std::shared_ptr<MappedFile> mapped(new MappedFile());
+
+	HANDLE file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+		nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return nullptr;
+	mapped->file = file;
+
+	LARGE_INTEGER size = {};
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		return nullptr;
+	mapped->length = static_cast<size_t>(size.QuadPart);
+
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0,
+		nullptr);
+	if (!mapping)
+		return nullptr;
+	mapped->mapping = mapping;
+
+	LPVOID view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view)
+		return nullptr;
+	mapped->view = static_cast<char const*>(view);
+
+	return mapped;
+}
+
+/**
+ * Unmaps the view and closes the underlying handles
+ */
+MappedFile::~MappedFile() {
+	if (view)
+		UnmapViewOfFile(view);
+	if (mapping)
+		CloseHandle(mapping);
+	if (file)
+		CloseHandle(file);
+}
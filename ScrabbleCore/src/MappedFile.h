@@ -0,0 +1,56 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Read-only memory-mapped file
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include <sal.h>
+
+/**
+ * Maps an entire file into memory for reading
+ *
+ * The contents are paged in by the operating system on demand, so opening a
+ * large file is cheap and the memory can be shared between processes.
+ */
+class MappedFile {
+public:
+	/**
+	 * Maps a file into memory
+	 *
+	 * @param path is the location of the file to map
+	 * @return mapped file, or nullptr if the file could not be mapped
+	 */
+	static std::shared_ptr<MappedFile> open(_In_ wchar_t const* path);
+
+	MappedFile(MappedFile const&) = delete;
+	MappedFile& operator=(MappedFile const&) = delete;
+	~MappedFile();
+
+	/**
+	 * @return start of the mapped contents
+	 */
+	char const* data() const {
+		return view;
+	}
+
+	/**
+	 * @return length of the mapped contents in bytes
+	 */
+	size_t size() const {
+		return length;
+	}
+
+private:
+	MappedFile() = default;
+
+	void* file = nullptr;
+	void* mapping = nullptr;
+	char const* view = nullptr;
+	size_t length = 0;
+};
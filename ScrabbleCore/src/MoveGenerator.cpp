@@ -0,0 +1,331 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Board-aware move generation
+ */
+
+#include "MoveGenerator.h"
+
+#include <algorithm>
+#include <string>
+#include <tuple>
+
+#include "Rack.h"
+
+namespace {
+	/**
+	 * Appel-Jacobson move generation along the lines of one direction
+	 *
+	 * A line is a row for moves across and a column for moves down, and a
+	 * position is the offset of a square along it.
+	 */
+	class Generator {
+	public:
+		/**
+		 * @param board is the board to play on
+		 * @param letters is the text typed in as the rack
+		 * @param moves receives the moves found
+		 */
+		Generator(_In_ Board const& board, _In_ std::string_view letters,
+			_Inout_ std::vector<Move>& moves) : board(board),
+			dawg(board.graph()), rack(makeRack(letters)), moves(moves) {
+		}
+
+		/**
+		 * Finds the moves in one direction
+		 *
+		 * @param way is the direction of the moves
+		 */
+		void run(_In_ Direction way) {
+			direction = way;
+			for (line = 0; line < Board::Size; ++line) {
+				for (int position = 0; position < Board::Size; ++position) {
+					if (isAnchor(position))
+						startAt(position);
+				}
+			}
+		}
+
+	private:
+		/**
+		 * @param position is the offset of the square along the line
+		 * @return row of the square
+		 */
+		int rowOf(_In_ int position) const {
+			return direction == Direction::Across ? line : position;
+		}
+
+		/**
+		 * @param position is the offset of the square along the line
+		 * @return column of the square
+		 */
+		int columnOf(_In_ int position) const {
+			return direction == Direction::Across ? position : line;
+		}
+
+		/**
+		 * @param position is the offset of the square along the line
+		 * @return contents of the square, or '\0' if it is off the board
+		 */
+		char tileAt(_In_ int position) const {
+			if (position < 0 || position >= Board::Size)
+				return '\0';
+			return board.at(rowOf(position), columnOf(position));
+		}
+
+		/**
+		 * @param position is the offset of the square along the line
+		 * @return true if a move must cover the square to connect
+		 */
+		bool isAnchor(_In_ int position) const {
+			int row = rowOf(position);
+			int column = columnOf(position);
+			if (board.at(row, column))
+				return false;
+			if (board.empty())
+				return row == Board::Center && column == Board::Center;
+
+			return (row > 0 && board.at(row - 1, column))
+				|| (row < Board::Size - 1 && board.at(row + 1, column))
+				|| (column > 0 && board.at(row, column - 1))
+				|| (column < Board::Size - 1 && board.at(row, column + 1));
+		}
+
+		/**
+		 * Generates the moves whose leftmost anchor is a square
+		 *
+		 * Tiles directly before the anchor must be part of the word. When
+		 * there are none, the part before the anchor is made from the rack
+		 * and may only cover squares that are not anchors themselves, so
+		 * the same move is never found from two anchors.
+		 *
+		 * @param position is the offset of the anchor along the line
+		 */
+		void startAt(_In_ int position) {
+			anchor = position;
+			word.clear();
+			if (tileAt(position - 1)) {
+				int first = position;
+				while (tileAt(first - 1))
+					--first;
+
+				uint32_t node = Dawg::Root;
+				for (int i = first; i < position && node != Dawg::Missing;
+					++i) {
+					word.push_back(tileAt(i));
+					node = dawg.follow(node, upper(tileAt(i)));
+				}
+
+				if (node != Dawg::Missing)
+					extendRight(node, position);
+				return;
+			}
+
+			int limit = 0;
+			while (position - limit - 1 >= 0
+				&& !isAnchor(position - limit - 1)
+				&& !tileAt(position - limit - 1))
+				++limit;
+			leftPart(Dawg::Root, limit);
+		}
+
+		/**
+		 * Places every prefix of up to a number of rack letters before the
+		 * anchor and extends each one across it
+		 *
+		 * @param node is the graph node reached by the letters so far
+		 * @param limit is the number of squares still free before the
+		 *        letters placed so far
+		 */
+		void leftPart(_In_ uint32_t node, _In_ int limit) {
+			extendRight(node, anchor);
+			if (!limit)
+				return;
+
+			Dawg::Node const& from = dawg.node(node);
+			for (uint32_t i = 0; i < from.edgeCount; ++i) {
+				Dawg::Edge const& edge = dawg.edge(from.firstEdge + i);
+				forEachTile(edge.letter, ~0u, [&] {
+					leftPart(edge.target, limit - 1);
+				});
+			}
+		}
+
+		/**
+		 * Extends the word through the squares from a position on
+		 *
+		 * @param node is the graph node reached by the word so far
+		 * @param position is the offset of the next square along the line
+		 */
+		void extendRight(_In_ uint32_t node, _In_ int position) {
+			if (char tile = tileAt(position)) {
+				uint32_t next = dawg.follow(node, upper(tile));
+				if (next != Dawg::Missing) {
+					word.push_back(tile);
+					extendRight(next, position + 1);
+					word.pop_back();
+				}
+				return;
+			}
+
+			Dawg::Node const& from = dawg.node(node);
+			if (position > anchor && from.terminal)
+				record(position);
+			if (position >= Board::Size)
+				return;
+
+			uint32_t allowed = board.crossCheck(direction, rowOf(position),
+				columnOf(position)).letters;
+			for (uint32_t i = 0; i < from.edgeCount; ++i) {
+				Dawg::Edge const& edge = dawg.edge(from.firstEdge + i);
+				forEachTile(edge.letter, allowed, [&] {
+					extendRight(edge.target, position + 1);
+				});
+			}
+		}
+
+		/**
+		 * Places a letter from the rack, first as its own tile and then
+		 * as a blank, and takes it back after each
+		 *
+		 * @param letter is the uppercase letter to place
+		 * @param allowed is the cross-check of the square
+		 * @param next continues the move with the letter placed
+		 */
+		template<typename Next>
+		void forEachTile(_In_ char letter, _In_ uint32_t allowed,
+			_In_ Next next) {
+			if (letter < 'A' || letter > 'Z')
+				return;
+			if (!(allowed & (1u << (letter - 'A'))))
+				return;
+
+			uint8_t& count = rack.counts[letter - 'A'];
+			if (count) {
+				--count;
+				word.push_back(letter);
+				next();
+				word.pop_back();
+				++count;
+			}
+
+			if (rack.blanks) {
+				--rack.blanks;
+				word.push_back(static_cast<char>(letter - 'A' + 'a'));
+				next();
+				word.pop_back();
+				++rack.blanks;
+			}
+		}
+
+		/**
+		 * Scores the word ending before a position and adds it as a move
+		 *
+		 * Premium squares only count under the tiles placed by the move.
+		 * Every placed tile that touches a perpendicular word scores that
+		 * word as well.
+		 *
+		 * @param end is the offset one past the last square of the word
+		 */
+		void record(_In_ int end) {
+			if (word.length() < 2)
+				return;
+
+			int first = end - static_cast<int>(word.length());
+
+			int points = 0;
+			int multiplier = 1;
+			int crossPoints = 0;
+			int placed = 0;
+			bool linked = false;
+			for (int position = first; position < end; ++position) {
+				char letter = word[position - first];
+				int value = Board::value(letter);
+				int row = rowOf(position);
+				int column = columnOf(position);
+				if (board.at(row, column)) {
+					points += value;
+					continue;
+				}
+
+				int letterMultiplier = 1;
+				int wordMultiplier = 1;
+				switch (Board::premium(row, column)) {
+					case Premium::DoubleLetter:
+						letterMultiplier = 2;
+						break;
+					case Premium::TripleLetter:
+						letterMultiplier = 3;
+						break;
+					case Premium::DoubleWord:
+						wordMultiplier = 2;
+						break;
+					case Premium::TripleWord:
+						wordMultiplier = 3;
+						break;
+					default:
+						break;
+				}
+
+				points += value * letterMultiplier;
+				multiplier *= wordMultiplier;
+				++placed;
+
+				CrossCheck const& check =
+					board.crossCheck(direction, row, column);
+				if (check.linked) {
+					crossPoints += (check.points + value * letterMultiplier)
+						* wordMultiplier;
+					linked = true;
+				}
+			}
+
+			// A single tile with words both ways is found across as well
+			if (direction == Direction::Down && placed == 1 && linked)
+				return;
+
+			Move move;
+			move.word = word;
+			move.row = static_cast<uint8_t>(rowOf(first));
+			move.column = static_cast<uint8_t>(columnOf(first));
+			move.direction = direction;
+			move.score = points * multiplier + crossPoints
+				+ (placed == Board::RackSize ? Board::Bingo : 0);
+			moves.push_back(std::move(move));
+		}
+
+		Board const& board;
+		Dawg const& dawg;
+		Rack rack;
+		std::vector<Move>& moves;
+		Direction direction = Direction::Across;
+		int line = 0;
+		int anchor = 0;
+		std::string word;
+	};
+}
+
+/**
+ * Finds every legal move a rack can make on a board
+ *
+ * @param board is the board to play on
+ * @param rack is the text typed in as the rack, where a question mark is a
+ *        blank and characters other than letters are ignored
+ * @return moves, sorted from the highest score down
+ */
+std::vector<Move> generateMoves(_In_ Board const& board,
+	_In_ std::string_view rack) {
+	std::vector<Move> moves;
+	Generator generator(board, rack, moves);
+	generator.run(Direction::Across);
+	generator.run(Direction::Down);
+
+	std::sort(moves.begin(), moves.end(), [](Move const& a, Move const& b) {
+		if (a.score != b.score)
+			return a.score > b.score;
+		return std::tie(a.row, a.column, a.direction, a.word)
+			< std::tie(b.row, b.column, b.direction, b.word);
+	});
+	return moves;
+}
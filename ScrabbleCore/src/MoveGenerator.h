@@ -0,0 +1,33 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Board-aware move generation
+ */
+
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include <sal.h>
+
+#include "Board.h"
+
+/**
+ * Finds every legal move a rack can make on a board
+ *
+ * Moves are built outward from anchor squares, which are the empty squares
+ * next to a tile or the center square on an empty board, by walking the
+ * board's word graph. Letters are only placed where the board's cached
+ * cross-checks allow them, so every perpendicular word formed is valid
+ * without being looked up again. Each move is reported once and is scored
+ * with its premium squares, perpendicular words and bingo bonus.
+ *
+ * @param board is the board to play on
+ * @param rack is the text typed in as the rack, where a question mark is a
+ *        blank and characters other than letters are ignored
+ * @return moves, sorted from the highest score down
+ */
+std::vector<Move> generateMoves(_In_ Board const& board,
+	_In_ std::string_view rack);
@@ -0,0 +1,198 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Word patterns compiled into bit-parallel automata
+ */
+
+#include "Pattern.h"
+
+#include <vector>
+
+namespace {
+	/**
+	 * Characters an element matches, with the bit after the last tile
+	 * standing for every character that is not a tile code
+	 */
+	constexpr uint64_t Anything = (uint64_t(1) << (Alphabet::MaxTiles + 1))
+		- 1;
+
+	/**
+	 * Element of a pattern once its repetitions are expanded
+	 */
+	struct Element {
+		uint64_t characters;
+		bool optional;
+		bool repeated;
+	};
+
+	/**
+	 * Reads a decimal number from a pattern
+	 *
+	 * @param text is the pattern
+	 * @param i is the position of the first digit, which is moved past the
+	 *        last one
+	 * @param value receives the number
+	 * @return false if there are no digits or the number is larger than any
+	 *         pattern can be
+	 */
+	bool readNumber(_In_ std::string_view text, _Inout_ size_t& i,
+		_Out_ size_t& value) {
+		value = 0;
+		size_t first = i;
+		while (i < text.length() && text[i] >= '0' && text[i] <= '9') {
+			value = value * 10 + static_cast<size_t>(text[i] - '0');
+			if (value > Pattern::MaxElements)
+				return false;
+			++i;
+		}
+
+		return i > first;
+	}
+}
+
+/**
+ * Compiles a pattern
+ *
+ * @param text is the pattern, which is copied
+ */
+Pattern::Pattern(_In_ std::string_view text) : source(text) {
+	compiled = compile();
+}
+
+/**
+ * Checks a whole word against the pattern
+ *
+ * @param word is the word to check
+ * @return true if the word matches
+ */
+bool Pattern::matches(_In_ std::string_view word) const {
+	State state = initial;
+	for (char character : word) {
+		state = advance(state, character);
+		if (!state)
+			return false;
+	}
+
+	return accepts(state);
+}
+
+/**
+ * Parses the pattern and fills in the transitions of its automaton
+ *
+ * Repetitions are expanded in place: {m,n} becomes m copies of the element
+ * followed by n - m optional copies, and {m,} becomes m copies followed by
+ * one optional copy that repeats. A star is an optional element that
+ * repeats and matches anything.
+ *
+ * @return false if the pattern is malformed or too long
+ */
+bool Pattern::compile() {
+	std::vector<Element> elements;
+	bool quantifiable = false;
+	for (size_t i = 0; i < source.length(); ++i) {
+		char character = source[i];
+		if (character == '{') {
+			if (!quantifiable)
+				return false;
+
+			size_t least = 0;
+			size_t most = 0;
+			if (!readNumber(source, ++i, least))
+				return false;
+
+			bool unbounded = false;
+			if (i < source.length() && source[i] == ',') {
+				++i;
+				if (i < source.length() && source[i] == '}')
+					unbounded = true;
+				else if (!readNumber(source, i, most) || most < least)
+					return false;
+			} else
+				most = least;
+
+			if (i >= source.length() || source[i] != '}')
+				return false;
+
+			Element element = elements.back();
+			elements.pop_back();
+			size_t copies = unbounded ? least + 1 : most;
+			if (elements.size() + copies > MaxElements)
+				return false;
+
+			for (size_t copy = 0; copy < copies; ++copy) {
+				Element next = element;
+				if (copy >= least) {
+					next.optional = true;
+					next.repeated = next.repeated || unbounded;
+				}
+				elements.push_back(next);
+			}
+
+			quantifiable = false;
+			continue;
+		}
+
+		Element element = { 0, false, false };
+		if (character == '*') {
+			element = { Anything, true, true };
+		} else if (character == '?') {
+			element.characters = Anything;
+		} else if (character == '[') {
+			bool negated = i + 1 < source.length() && source[i + 1] == '^';
+			i += negated ? 2 : 1;
+			for (; i < source.length() && source[i] != ']'; ++i) {
+				int first = Alphabet::tileOf(source[i]);
+				int last = first;
+				if (i + 2 < source.length() && source[i + 1] == '-'
+					&& source[i + 2] != ']') {
+					last = Alphabet::tileOf(source[i + 2]);
+					i += 2;
+				}
+
+				if (first < 0 || last < first)
+					return false;
+				for (int letter = first; letter <= last; ++letter)
+					element.characters |= uint64_t(1) << letter;
+			}
+
+			if (i >= source.length() || !element.characters)
+				return false;
+			if (negated)
+				element.characters ^= Anything;
+		} else {
+			int letter = Alphabet::tileOf(character);
+			if (letter < 0)
+				return false;
+			element.characters = uint64_t(1) << letter;
+		}
+
+		if (elements.size() >= MaxElements)
+			return false;
+
+		elements.push_back(element);
+		quantifiable = true;
+	}
+
+	for (size_t i = 0; i < elements.size(); ++i) {
+		State bit = State(1) << (i + 1);
+		for (size_t c = 0; c < letters.size(); ++c) {
+			if (elements[i].characters & (uint64_t(1) << c))
+				letters[c] |= bit;
+		}
+
+		if (elements[i].optional)
+			optional |= bit;
+		if (elements[i].repeated)
+			repeated |= bit;
+	}
+
+	initial = close(1);
+	accepting = State(1) << elements.size();
+
+	size_t starting = 0;
+	for (char letter = 'A'; letter <= 'Z'; ++letter)
+		starting += advance(initial, letter) ? 1 : 0;
+	selective = starting <= 13;
+	return true;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Word patterns compiled into bit-parallel automata
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <sal.h>
+
+#include "Alphabet.h"
+
+/**
+ * Shape that whole words are matched against
+ *
+ * A pattern is a sequence of elements that each match one character. A
+ * letter matches itself, a question mark matches any character and a class
+ * such as [AEIOU] or [A-E] matches any of its letters, or any character but
+ * its letters if it starts with a caret. Any element can be followed by {n},
+ * {m,n} or {m,} to repeat it that many times, which is how lengths are
+ * constrained, and a star matches any run of characters. Letters are
+ * matched regardless of case, and a range runs over the tiles in the order
+ * of their codes.
+ *
+ * The elements are compiled into a nondeterministic automaton whose states
+ * are the bits of one integer, so a set of states is advanced over a letter
+ * with a few shifts and masks. Walking a word graph can carry the set along
+ * and drop every branch where it becomes empty.
+ */
+class Pattern {
+public:
+	/**
+	 * Set of automaton states, where bit zero is the start and bit i is
+	 * reached once the first i elements have matched
+	 */
+	using State = uint64_t;
+
+	/**
+	 * Largest number of elements a pattern can have once its repetitions
+	 * are expanded
+	 */
+	static constexpr size_t MaxElements = 63;
+
+	/**
+	 * Compiles a pattern
+	 *
+	 * @param text is the pattern, which is copied
+	 */
+	explicit Pattern(_In_ std::string_view text);
+
+	/**
+	 * @return true if the pattern compiled, since a pattern that did not
+	 *         never matches anything
+	 */
+	bool valid() const {
+		return compiled;
+	}
+
+	/**
+	 * @return true if at most half of the letters can start a matching
+	 *         word, so walking a word graph with the pattern prunes most
+	 *         branches right away
+	 */
+	bool anchored() const {
+		return selective;
+	}
+
+	/**
+	 * @return text the pattern was compiled from
+	 */
+	std::string_view text() const {
+		return source;
+	}
+
+	/**
+	 * @return states the automaton is in before any character is read
+	 */
+	State start() const {
+		return initial;
+	}
+
+	/**
+	 * Advances a set of states over one character
+	 *
+	 * @param state is the current set of states
+	 * @param character is the next character of the word
+	 * @return next set of states, which is empty if no word with the
+	 *         characters read so far can match
+	 */
+	State advance(_In_ State state, _In_ char character) const {
+		State letter = letters[slot(character)];
+		return close(((state << 1) & letter) | (state & letter & repeated));
+	}
+
+	/**
+	 * @param state is the set of states after a whole word
+	 * @return true if the word matches
+	 */
+	bool accepts(_In_ State state) const {
+		return state & accepting;
+	}
+
+	/**
+	 * Checks a whole word against the pattern
+	 *
+	 * @param word is the word to check
+	 * @return true if the word matches
+	 */
+	bool matches(_In_ std::string_view word) const;
+
+private:
+	/**
+	 * @param character is a character of a word
+	 * @return position of the character's transitions, which is shared by
+	 *         every character that is not a tile code
+	 */
+	static size_t slot(_In_ char character) {
+		int tile = Alphabet::tileOf(character);
+		return tile < 0 ? Alphabet::MaxTiles : static_cast<size_t>(tile);
+	}
+
+	/**
+	 * Adds the states reachable by skipping optional elements
+	 *
+	 * @param state is a set of states
+	 * @return set with every state that skipping can reach
+	 */
+	State close(_In_ State state) const {
+		while (true) {
+			State next = state | ((state << 1) & optional);
+			if (next == state)
+				return state;
+			state = next;
+		}
+	}
+
+	bool compile();
+
+	std::string source;
+	std::array<State, Alphabet::MaxTiles + 1> letters = {};
+	State optional = 0;
+	State repeated = 0;
+	State initial = 0;
+	State accepting = 0;
+	bool selective = false;
+	bool compiled = false;
+};
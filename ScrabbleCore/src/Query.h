@@ -0,0 +1,175 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Query parameters and results shared by every solver engine
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include <sal.h>
+
+#include "Pattern.h"
+
+class Profile;
+
+/**
+ * Sorting method used when outputting possible words from the dictionary
+ */
+enum class SortingMethod : uint8_t {
+	None, Points, Length
+};
+
+/**
+ * Index used to find the words that can be made from a rack
+ *
+ * Automatic picks whichever engine is expected to be fastest for the query.
+ * Gaddag builds the lexicon's GADDAG if it has not been built yet.
+ */
+enum class Engine : uint8_t {
+	Automatic, Scan, Signature, Dawg, Substring, Gaddag, Bitset
+};
+
+/**
+ * Parameters of a single search against the dictionary
+ *
+ * All of the strings are borrowed and must outlive the call they are passed
+ * to. Empty filters match every word. If a pattern is given, only the words
+ * it matches are kept, and it must outlive the call as well. A limit of
+ * zero keeps every match, and any other limit keeps only that many of the
+ * best matches. If a cancellation flag is given, the search gives up as soon
+ * as it notices the flag is set and returns nothing. If a profile is given,
+ * the timings and counters of the search are added to it.
+ *
+ * Tiles already on the board can be given as well, and then only the words
+ * that run through them are kept. The tiles cost nothing and score their
+ * values, unless they are lowercase and so blanks. An offset other than
+ * SIZE_MAX is the number of letters of the word before the first tile. A
+ * hook query treats the tiles as a word that is already played and keeps
+ * only the longer words it can be extended into, which use at least one
+ * letter of the rack.
+ */
+struct Query {
+	std::string_view letters;
+	std::string_view startsWith;
+	std::string_view endsWith;
+	std::string_view contains;
+	std::string_view through;
+	size_t offset = SIZE_MAX;
+	bool hook = false;
+	Pattern const* pattern = nullptr;
+	SortingMethod method = SortingMethod::None;
+	Engine engine = Engine::Automatic;
+	size_t limit = 0;
+	std::atomic<bool> const* cancelled = nullptr;
+	Profile* profile = nullptr;
+};
+
+/**
+ * Word that can be made from a query's letters
+ *
+ * The word itself is not stored, only its position in the dictionary that
+ * was searched.
+ */
+struct Match {
+	uint32_t index;
+	int points;
+};
+
+/**
+ * Read-only view of a list of matches
+ *
+ * Lets results be handed around without copying them and without tying the
+ * receiver to the container they are stored in. The matches must outlive
+ * the span.
+ */
+class MatchSpan {
+public:
+	MatchSpan() = default;
+
+	/**
+	 * @param data is the first match
+	 * @param count is the number of matches
+	 */
+	MatchSpan(_In_reads_(count) Match const* data, _In_ size_t count) :
+		first(data), count(count) {
+	}
+
+	/**
+	 * @param matches is the list of matches to view
+	 */
+	MatchSpan(_In_ std::vector<Match> const& matches) :
+		first(matches.data()), count(matches.size()) {
+	}
+
+	Match const* begin() const {
+		return first;
+	}
+
+	Match const* end() const {
+		return first + count;
+	}
+
+	/**
+	 * @return number of matches
+	 */
+	size_t size() const {
+		return count;
+	}
+
+	/**
+	 * @return true if there are no matches
+	 */
+	bool empty() const {
+		return !count;
+	}
+
+	/**
+	 * @param i is the position of a match
+	 * @return match at the position
+	 */
+	Match const& operator[](_In_ size_t i) const {
+		return first[i];
+	}
+
+private:
+	Match const* first = nullptr;
+	size_t count = 0;
+};
+
+/**
+ * Checks whether a query has been cancelled
+ *
+ * @param query is the query to check
+ * @return true if the query's cancellation flag is set
+ */
+inline bool isCancelled(_In_ Query const& query) {
+	return query.cancelled
+		&& query.cancelled->load(std::memory_order_relaxed);
+}
+
+/**
+ * Checks a word against the starts with, ends with and contains filters and
+ * the pattern
+ *
+ * @param query contains the filters to check
+ * @param word is the word being checked
+ * @return true if the word passes every filter
+ */
+inline bool passesFilters(_In_ Query const& query,
+	_In_ std::string_view word) {
+	if (word.substr(0, query.startsWith.length()) != query.startsWith)
+		return false;
+	if (word.length() < query.endsWith.length() || word.substr(
+		word.length() - query.endsWith.length()) != query.endsWith)
+		return false;
+	if (word.find(query.contains) == std::string_view::npos)
+		return false;
+	return !query.pattern || query.pattern->matches(word);
+}
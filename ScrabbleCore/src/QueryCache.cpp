@@ -0,0 +1,128 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Least recently used cache of query results
+ */
+
+#include "QueryCache.h"
+
+#include <cstdint>
+#include <utility>
+
+#include "Rack.h"
+#include "Solver.h"
+
+/**
+ * Looks up the matches of a query
+ *
+ * A hit moves the entry to the front of the list. If it was stored with a
+ * different sorting method, its matches are sorted again in place, except
+ * when no sorting is asked for, in which case any order will do.
+ *
+ * @param dictionary is the word list the matches were found in
+ * @param query contains the letters, filters and sorting method
+ * @return matches in the order given by the sorting method, which stay valid
+ *         until the cache is next changed, or nullptr on a miss
+ */
+std::vector<Match> const* QueryCache::find(_In_ Dictionary const& dictionary,
+	_In_ Query const& query) {
+	if (query.limit) {
+		missCount.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	auto found = lookup.find(makeKey(query));
+	if (found == lookup.end()) {
+		missCount.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	hitCount.fetch_add(1, std::memory_order_relaxed);
+	entries.splice(entries.begin(), entries, found->second);
+
+	Entry& entry = *found->second;
+	if (query.method != SortingMethod::None && query.method != entry.method) {
+		sortMatches(dictionary, query.method, entry.matches);
+		entry.method = query.method;
+	}
+
+	return &entry.matches;
+}
+
+/**
+ * Remembers the matches of a query
+ *
+ * An existing entry for the same key is replaced. Otherwise, the least
+ * recently used entry is evicted if the cache is full.
+ *
+ * @param query contains the letters, filters and sorting method
+ * @param matches are the query's matches, sorted by its sorting method
+ */
+void QueryCache::insert(_In_ Query const& query,
+	_In_ std::vector<Match> matches) {
+	if (!limit || query.limit)
+		return;
+
+	std::string key = makeKey(query);
+	auto found = lookup.find(key);
+	if (found != lookup.end()) {
+		entries.splice(entries.begin(), entries, found->second);
+		found->second->method = query.method;
+		found->second->matches = std::move(matches);
+		return;
+	}
+
+	if (entries.size() == limit) {
+		lookup.erase(entries.back().key);
+		entries.pop_back();
+	}
+
+	entries.push_front({ key, query.method, std::move(matches) });
+	lookup.emplace(std::move(key), entries.begin());
+}
+
+/**
+ * Forgets every query
+ */
+void QueryCache::clear() {
+	lookup.clear();
+	entries.clear();
+}
+
+/**
+ * Builds the key a query is cached under
+ *
+ * The key holds the rack's tile counts and its blank count, followed
+ * by each filter and the pattern preceded by its length, so that no two
+ * different queries can produce the same key. A query without a pattern
+ * gets a length that no pattern can have.
+ *
+ * @param query contains the letters and filters
+ * @return key of the query
+ */
+std::string QueryCache::makeKey(_In_ Query const& query) {
+	Rack rack = makeRack(query.letters);
+
+	std::string key;
+	std::string_view pattern =
+		query.pattern ? query.pattern->text() : std::string_view();
+	key.reserve(WordIndex::Stride + 1 + 4 * sizeof(size_t)
+		+ query.startsWith.length() + query.endsWith.length()
+		+ query.contains.length() + pattern.length());
+	key.append(reinterpret_cast<char const*>(rack.counts), WordIndex::Stride);
+	key.push_back(static_cast<char>(rack.blanks < 255 ? rack.blanks : 255));
+
+	for (std::string_view filter : { query.startsWith, query.endsWith,
+		query.contains }) {
+		size_t length = filter.length();
+		key.append(reinterpret_cast<char const*>(&length), sizeof(length));
+		key.append(filter);
+	}
+
+	size_t length = query.pattern ? pattern.length() : SIZE_MAX;
+	key.append(reinterpret_cast<char const*>(&length), sizeof(length));
+	key.append(pattern);
+
+	return key;
+}
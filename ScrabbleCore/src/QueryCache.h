@@ -0,0 +1,114 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Least recently used cache of query results
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sal.h>
+
+#include "Dictionary.h"
+#include "Query.h"
+
+/**
+ * Remembers the matches of recently solved queries
+ *
+ * Entries are keyed by the rack's letter counts and blanks, so racks typed
+ * in a different order or case share an entry, together with the three
+ * filters. The sorting method and engine are not part of the key, since
+ * they do not change which words match. Looking up a query that was cached
+ * with another sorting method only sorts the stored matches again. Once the
+ * cache is full, the least recently used entry is evicted. Queries with a
+ * limit are never cached.
+ *
+ * The cache is meant to be used by a single thread, but its hit and miss
+ * counters may be read from any thread.
+ */
+class QueryCache {
+public:
+	/**
+	 * @param capacity is the maximum number of queries to remember
+	 */
+	explicit QueryCache(_In_ size_t capacity = 64) : limit(capacity) {
+	}
+
+	QueryCache(QueryCache const&) = delete;
+	QueryCache& operator=(QueryCache const&) = delete;
+
+	/**
+	 * Looks up the matches of a query
+	 *
+	 * @param dictionary is the word list the matches were found in
+	 * @param query contains the letters, filters and sorting method
+	 * @return matches in the order given by the sorting method, which stay
+	 *         valid until the cache is next changed, or nullptr on a miss
+	 */
+	std::vector<Match> const* find(_In_ Dictionary const& dictionary,
+		_In_ Query const& query);
+
+	/**
+	 * Remembers the matches of a query
+	 *
+	 * @param query contains the letters, filters and sorting method
+	 * @param matches are the query's matches, sorted by its sorting method
+	 */
+	void insert(_In_ Query const& query, _In_ std::vector<Match> matches);
+
+	/**
+	 * Forgets every query
+	 */
+	void clear();
+
+	/**
+	 * @return number of queries remembered
+	 */
+	size_t size() const {
+		return entries.size();
+	}
+
+	/**
+	 * @return maximum number of queries remembered
+	 */
+	size_t capacity() const {
+		return limit;
+	}
+
+	/**
+	 * @return number of lookups that found their query
+	 */
+	uint64_t hits() const {
+		return hitCount.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @return number of lookups that did not find their query
+	 */
+	uint64_t misses() const {
+		return missCount.load(std::memory_order_relaxed);
+	}
+
+private:
+	struct Entry {
+		std::string key;
+		SortingMethod method;
+		std::vector<Match> matches;
+	};
+
+	static std::string makeKey(_In_ Query const& query);
+
+	size_t limit;
+	std::list<Entry> entries;
+	std::unordered_map<std::string, std::list<Entry>::iterator> lookup;
+	std::atomic<uint64_t> hitCount = 0;
+	std::atomic<uint64_t> missCount = 0;
+};
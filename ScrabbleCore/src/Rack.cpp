@@ -0,0 +1,298 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Rack histograms and the vectorized rack feasibility kernel
+ */
+
+#include "Rack.h"
+
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) \
+	|| defined(__i386__)
+#define RACK_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(RACK_X86) && defined(__GNUC__)
+#define RACK_AVX2 __attribute__((target("avx2")))
+#else
+#define RACK_AVX2
+#endif
+
+namespace {
+	using Kernel = size_t(*)(WordIndex const&, Rack const&, size_t, size_t,
+		uint32_t*);
+
+	/**
+	 * Tests words one letter at a time
+	 *
+	 * Used for the words left over after the vectorized kernels have
+	 * consumed every full group of four, and on processors without SIMD.
+	 *
+	 * @param index is the letter count index to test
+	 * @param rack is the histogram of the available letters
+	 * @param begin is the position of the first word to test
+	 * @param end is one past the position of the last word to test
+	 * @param feasible receives the positions of the feasible words
+	 * @return number of positions written to feasible
+	 */
+	size_t findScalar(_In_ WordIndex const& index, _In_ Rack const& rack,
+		_In_ size_t begin, _In_ size_t end, _Out_ uint32_t* feasible) {
+		size_t found = 0;
+		for (size_t position = begin; position < end; ++position) {
+			uint8_t const* counts = index.counts(position);
+			int missing = 0;
+			for (size_t i = 0; i < WordIndex::Stride; ++i) {
+				int difference = counts[i] - rack.counts[i];
+				missing += difference > 0 ? difference : 0;
+			}
+
+			feasible[found] = static_cast<uint32_t>(position);
+			found += missing <= rack.blanks;
+		}
+
+		return found;
+	}
+
+#ifdef RACK_X86
+	/**
+	 * Tests four words at a time using SSE2
+	 *
+	 * Each record is split into two halves that are subtracted from the rack
+	 * with unsigned saturation, so only missing letters remain. The halves
+	 * are added together and summed horizontally, then the sums for four
+	 * words are packed into 16-bit lanes and compared to the blank count in
+	 * a single instruction.
+	 *
+	 * @param index is the letter count index to test
+	 * @param rack is the histogram of the available letters
+	 * @param begin is the position of the first word to test
+	 * @param end is one past the position of the last word to test
+	 * @param feasible receives the positions of the feasible words
+	 * @return number of positions written to feasible
+	 */
+	size_t findSse2(_In_ WordIndex const& index, _In_ Rack const& rack,
+		_In_ size_t begin, _In_ size_t end, _Out_ uint32_t* feasible) {
+		__m128i const zero = _mm_setzero_si128();
+		__m128i const low = _mm_load_si128(
+			reinterpret_cast<__m128i const*>(rack.counts));
+		__m128i const high = _mm_load_si128(
+			reinterpret_cast<__m128i const*>(rack.counts + 16));
+		__m128i const limit = _mm_set1_epi16(
+			static_cast<short>(std::min(rack.blanks, INT16_MAX)));
+
+		auto missing = [&](_In_ size_t position) {
+			uint8_t const* counts = index.counts(position);
+			__m128i first = _mm_loadu_si128(
+				reinterpret_cast<__m128i const*>(counts));
+			__m128i second = _mm_loadu_si128(
+				reinterpret_cast<__m128i const*>(counts + 16));
+			__m128i difference = _mm_adds_epu8(_mm_subs_epu8(first, low),
+				_mm_subs_epu8(second, high));
+			return _mm_sad_epu8(difference, zero);
+		};
+
+		size_t found = 0;
+		size_t position = begin;
+		for (; position + 4 <= end; position += 4) {
+			__m128i sums = _mm_or_si128(
+				_mm_or_si128(missing(position),
+					_mm_slli_epi64(missing(position + 1), 16)),
+				_mm_or_si128(_mm_slli_epi64(missing(position + 2), 32),
+					_mm_slli_epi64(missing(position + 3), 48)));
+			sums = _mm_add_epi16(sums, _mm_unpackhi_epi64(sums, sums));
+			int rejected = _mm_movemask_epi8(_mm_cmpgt_epi16(sums, limit));
+
+			for (int i = 0; i < 4; ++i) {
+				feasible[found] = static_cast<uint32_t>(position + i);
+				found += !((rejected >> (i * 2)) & 1);
+			}
+		}
+
+		return found + findScalar(index, rack, position, end,
+			feasible + found);
+	}
+
+	/**
+	 * Tests four words at a time using AVX2
+	 *
+	 * Works like the SSE2 kernel, but each record is handled by a single
+	 * 32-byte subtraction.
+	 *
+	 * @param index is the letter count index to test
+	 * @param rack is the histogram of the available letters
+	 * @param begin is the position of the first word to test
+	 * @param end is one past the position of the last word to test
+	 * @param feasible receives the positions of the feasible words
+	 * @return number of positions written to feasible
+	 */
+	RACK_AVX2 size_t findAvx2(_In_ WordIndex const& index,
+		_In_ Rack const& rack, _In_ size_t begin, _In_ size_t end,
+		_Out_ uint32_t* feasible) {
+		__m256i const zero = _mm256_setzero_si256();
+		__m256i const counts = _mm256_load_si256(
+			reinterpret_cast<__m256i const*>(rack.counts));
+		__m128i const limit = _mm_set1_epi16(
+			static_cast<short>(std::min(rack.blanks, INT16_MAX)));
+
+		auto missing = [&](_In_ size_t position) RACK_AVX2 {
+			__m256i record = _mm256_loadu_si256(
+				reinterpret_cast<__m256i const*>(index.counts(position)));
+			return _mm256_sad_epu8(_mm256_subs_epu8(record, counts), zero);
+		};
+
+		size_t found = 0;
+		size_t position = begin;
+		for (; position + 4 <= end; position += 4) {
+			__m256i sums = _mm256_or_si256(
+				_mm256_or_si256(missing(position),
+					_mm256_slli_epi64(missing(position + 1), 16)),
+				_mm256_or_si256(_mm256_slli_epi64(missing(position + 2), 32),
+					_mm256_slli_epi64(missing(position + 3), 48)));
+			__m128i total = _mm_add_epi16(_mm256_castsi256_si128(sums),
+				_mm256_extracti128_si256(sums, 1));
+			total = _mm_add_epi16(total, _mm_unpackhi_epi64(total, total));
+			int rejected = _mm_movemask_epi8(_mm_cmpgt_epi16(total, limit));
+
+			for (int i = 0; i < 4; ++i) {
+				feasible[found] = static_cast<uint32_t>(position + i);
+				found += !((rejected >> (i * 2)) & 1);
+			}
+		}
+
+		return found + findScalar(index, rack, position, end,
+			feasible + found);
+	}
+
+	/**
+	 * Checks whether the processor and operating system support AVX2
+	 *
+	 * @return true if AVX2 instructions can be executed
+	 */
+	bool supportsAvx2() {
+#ifdef _MSC_VER
+		int info[4] = {};
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+			return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+#endif
+
+	/**
+	 * Picks the fastest kernel supported by the processor
+	 *
+	 * @return kernel used by findFeasible
+	 */
+	Kernel selectKernel() {
+#ifdef RACK_X86
+		if (supportsAvx2())
+			return findAvx2;
+		return findSse2;
+#else
+		return findScalar;
+#endif
+	}
+}
+
+/**
+ * Counts the letters of a query
+ *
+ * @param letters is the rack in tile codes
+ * @return histogram of the rack
+ */
+Rack makeRack(_In_ std::string_view letters) {
+	Rack rack = {};
+	for (char letter : letters) {
+		uint8_t* count = nullptr;
+		int tile = Alphabet::tileOf(letter);
+		if (tile >= 0)
+			count = &rack.counts[tile];
+		else if (letter == '?')
+			++rack.blanks;
+
+		if (count && *count < UINT8_MAX)
+			++*count;
+	}
+
+	return rack;
+}
+
+/**
+ * Finds the words that can be made from a rack
+ *
+ * The kernel is selected the first time this is called.
+ *
+ * @param index is the letter count index to test
+ * @param rack is the histogram of the available letters
+ * @param begin is the position of the first word to test
+ * @param end is one past the position of the last word to test
+ * @param feasible receives the positions of the feasible words, and must
+ *        have room for end - begin entries
+ * @return number of positions written to feasible
+ */
+size_t findFeasible(_In_ WordIndex const& index, _In_ Rack const& rack,
+	_In_ size_t begin, _In_ size_t end, _Out_writes_(end - begin)
+	uint32_t* feasible) {
+	static Kernel const kernel = selectKernel();
+	return kernel(index, rack, begin, end, feasible);
+}
+
+/**
+ * Checks whether a single word can be made from a rack
+ *
+ * @param counts is the letter count record of a word
+ * @param rack is the histogram of the available letters
+ * @return true if the rack's blanks cover every missing letter
+ */
+bool isFeasible(_In_reads_(WordIndex::Stride) uint8_t const* counts,
+	_In_ Rack const& rack) {
+	int missing = 0;
+	for (size_t i = 0; i < WordIndex::Stride; ++i) {
+		int difference = counts[i] - rack.counts[i];
+		missing += difference > 0 ? difference : 0;
+	}
+
+	return missing <= rack.blanks;
+}
+
+/**
+ * Calculates the points lost by covering missing letters with blanks
+ *
+ * The word's score was computed when it was indexed, so instead of scoring
+ * the word again, the shortfall of each letter is weighed against the
+ * letter's value. The whole padded record is covered without branches, so
+ * the loop compiles to a few vector instructions.
+ *
+ * @param counts is the letter count record of a word
+ * @param rack is the histogram of the available letters
+ * @param values is the point value of the tile at each offset of a record
+ * @return sum of the point values of the letters missing from the rack
+ */
+int blankPenalty(_In_reads_(WordIndex::Stride) uint8_t const* counts,
+	_In_ Rack const& rack, _In_reads_(WordIndex::Stride)
+	uint8_t const* values) {
+	int penalty = 0;
+	for (size_t i = 0; i < WordIndex::Stride; ++i) {
+		int missing = std::max(counts[i] - rack.counts[i], 0);
+		penalty += missing * values[i];
+	}
+
+	return penalty;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Rack histograms and the vectorized rack feasibility kernel
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include <sal.h>
+
+#include "Alphabet.h"
+#include "WordIndex.h"
+
+/**
+ * Letters available to a query, laid out like a WordIndex record
+ *
+ * Each tile has one byte with A at offset zero, the bytes of tiles that the
+ * alphabet does not have are zero, and blanks are counted separately.
+ * Counts saturate at 255.
+ */
+struct Rack {
+	alignas(32) uint8_t counts[WordIndex::Stride];
+	int blanks;
+};
+
+/**
+ * Counts the letters of a query
+ *
+ * Letters are counted case-insensitively and question marks are counted as
+ * blanks. Any other character is ignored.
+ *
+ * @param letters is the rack in tile codes
+ * @return histogram of the rack
+ */
+Rack makeRack(_In_ std::string_view letters);
+
+/**
+ * Finds the words that can be made from a rack
+ *
+ * A word is feasible when the number of its letters missing from the rack is
+ * no greater than the number of blanks. The test is run with AVX2 or SSE2
+ * when the processor supports it and with a scalar loop otherwise.
+ *
+ * @param index is the letter count index to test
+ * @param rack is the histogram of the available letters
+ * @param begin is the position of the first word to test
+ * @param end is one past the position of the last word to test
+ * @param feasible receives the positions of the feasible words, and must
+ *        have room for end - begin entries
+ * @return number of positions written to feasible
+ */
+size_t findFeasible(_In_ WordIndex const& index, _In_ Rack const& rack,
+	_In_ size_t begin, _In_ size_t end, _Out_writes_(end - begin)
+	uint32_t* feasible);
+
+/**
+ * Checks whether a single word can be made from a rack
+ *
+ * Used when only a scattered set of candidate words needs checking, where
+ * the block kernel of findFeasible does not apply.
+ *
+ * @param counts is the letter count record of a word
+ * @param rack is the histogram of the available letters
+ * @return true if the rack's blanks cover every missing letter
+ */
+bool isFeasible(_In_reads_(WordIndex::Stride) uint8_t const* counts,
+	_In_ Rack const& rack);
+
+/**
+ * Calculates the points lost by covering missing letters with blanks
+ *
+ * @param counts is the letter count record of a word
+ * @param rack is the histogram of the available letters
+ * @param values is the point value of the tile at each offset of a record
+ * @return sum of the point values of the letters missing from the rack
+ */
+int blankPenalty(_In_reads_(WordIndex::Stride) uint8_t const* counts,
+	_In_ Rack const& rack, _In_reads_(WordIndex::Stride)
+	uint8_t const* values);
+
+/**
+ * Rack that a walk over a word graph spends tiles from as it goes deeper
+ * and gives them back as it returns
+ *
+ * A letter spends the rack's own tile if one is left, otherwise a blank,
+ * which scores nothing. Characters that are not codes of the index's tiles
+ * are free, matching the scores of the letter count index.
+ */
+class RackSpender {
+public:
+	/**
+	 * @param letters is the rack in tile codes
+	 * @param index is the letter count index that holds the point values
+	 *        of the tiles
+	 */
+	RackSpender(_In_ std::string_view letters, _In_ WordIndex const& index)
+		: rack(makeRack(letters)), blanks(rack.blanks),
+		values(index.values()), tiles(index.tiles()) {
+	}
+
+	/**
+	 * @param letter is a character of a word
+	 * @return position of the tile the character stands for, or -1 if it
+	 *         is free
+	 */
+	int tileOf(_In_ char letter) const {
+		int tile = Alphabet::tileOf(letter);
+		return tile < 0 || static_cast<size_t>(tile) >= tiles ? -1 : tile;
+	}
+
+	/**
+	 * @param tile is the position of a tile
+	 * @return point value of the tile
+	 */
+	int value(_In_ int tile) const {
+		return values[tile];
+	}
+
+	/**
+	 * Takes the tile for a letter from the rack
+	 *
+	 * @param letter is the uppercase letter to spend
+	 * @param points receives the value of the tile spent, zero for a free
+	 *        letter or -1 for a blank
+	 * @return true if the rack had a tile or blank to spend
+	 */
+	bool spend(_In_ char letter, _Out_ int& points) {
+		points = 0;
+		int tile = tileOf(letter);
+		if (tile < 0)
+			return true;
+
+		uint8_t& count = rack.counts[tile];
+		if (count) {
+			--count;
+			points = values[tile];
+			return true;
+		}
+
+		if (blanks) {
+			--blanks;
+			points = -1;
+			return true;
+		}
+
+		return false;
+	}
+
+	/**
+	 * Puts back the tile that spend() took for a letter
+	 *
+	 * @param letter is the letter that was spent
+	 * @param points is the value that spend() gave for it
+	 */
+	void refund(_In_ char letter, _In_ int points) {
+		if (points > 0)
+			++rack.counts[Alphabet::tileOf(letter)];
+		else if (points < 0)
+			++blanks;
+	}
+
+private:
+	Rack rack;
+	int blanks;
+	uint8_t const* values;
+	size_t tiles;
+};
@@ -0,0 +1,96 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Compile-time letter score tables and the kernels that read them
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include <sal.h>
+
+/**
+ * Letter distribution whose point values a word is scored with
+ *
+ * Only the English tile set is compiled in. Other languages give their
+ * point values in the description of their Alphabet.
+ */
+enum class TileSet : uint8_t {
+	Standard
+};
+
+/**
+ * Point values of the letters A to Z in a tile set, and the number of tiles
+ * of each letter and of blanks in a full bag
+ */
+template<TileSet set>
+struct Tiles;
+
+/**
+ * English tile set
+ */
+template<>
+struct Tiles<TileSet::Standard> {
+	static constexpr uint8_t values[26] = { 1, 3, 3, 2, 1, 4, 2, 4, 1, 8, 5,
+		1, 3, 1, 1, 3, 10, 1, 1, 1, 1, 4, 4, 8, 4, 10 };
+	static constexpr uint8_t counts[26] = { 9, 2, 2, 4, 12, 2, 3, 2, 9, 1, 1,
+		4, 2, 6, 8, 2, 1, 6, 4, 6, 4, 2, 2, 1, 2, 1 };
+	static constexpr uint8_t blanks = 2;
+};
+
+/**
+ * Builds a table of points indexed by character
+ *
+ * @param values holds the point values of the letters A to Z
+ * @param blanks is true if lowercase letters stand for blanks, which score
+ *        nothing, instead of scoring like their uppercase letters
+ * @return points of every character, which is zero for anything that is not
+ *         a letter
+ */
+constexpr std::array<uint8_t, 256> makeScoreTable(
+	_In_ uint8_t const (&values)[26], _In_ bool blanks) {
+	std::array<uint8_t, 256> table = {};
+	for (int i = 0; i < 26; ++i) {
+		table['A' + i] = values[i];
+		table['a' + i] = blanks ? 0 : values[i];
+	}
+
+	return table;
+}
+
+/**
+ * Points of every character, scoring both cases of a letter alike
+ */
+template<TileSet set>
+constexpr std::array<uint8_t, 256> LetterScores =
+	makeScoreTable(Tiles<set>::values, false);
+
+/**
+ * Points of every character on the board, where a lowercase letter is a
+ * blank and scores nothing
+ */
+template<TileSet set>
+constexpr std::array<uint8_t, 256> TileScores =
+	makeScoreTable(Tiles<set>::values, true);
+
+/**
+ * Adds up the points of a word
+ *
+ * Every character is a single table lookup with no case or range checks.
+ *
+ * @param word is the word to score
+ * @return point total of the word in the tile set
+ */
+template<TileSet set>
+int scoreWord(_In_ std::string_view word) {
+	std::array<uint8_t, 256> const& table = LetterScores<set>;
+	int points = 0;
+	for (char letter : word)
+		points += table[static_cast<unsigned char>(letter)];
+
+	return points;
+}
@@ -0,0 +1,26 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Public interface of the solver library
+ */
+
+#pragma once
+
+#include "Alphabet.h"
+#include "Arena.h"
+#include "Board.h"
+#include "Dictionary.h"
+#include "DictionaryLoader.h"
+#include "Equity.h"
+#include "Gaddag.h"
+#include "LeaveTable.h"
+#include "Lexicon.h"
+#include "LexiconImage.h"
+#include "LexiconLibrary.h"
+#include "MoveGenerator.h"
+#include "Pattern.h"
+#include "Query.h"
+#include "Scoring.h"
+#include "Solver.h"
+#include "Trace.h"
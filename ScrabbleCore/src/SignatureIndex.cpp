@@ -0,0 +1,269 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Anagram signature index for rack lookups without a dictionary scan
+ */
+
+#include "SignatureIndex.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+
+#include "Solver.h"
+
+namespace {
+	/**
+	 * Scrambles an integer into a well distributed 64-bit value
+	 *
+	 * @param value is the integer to scramble
+	 * @return scrambled value
+	 */
+	constexpr uint64_t mix(_In_ uint64_t value) {
+		value += 0x9E3779B97F4A7C15ull;
+		value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+		value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+		return value ^ (value >> 31);
+	}
+
+	/**
+	 * Builds the weight added to a signature's hash for each letter
+	 *
+	 * @return table of odd weights, one per tile
+	 */
+	constexpr std::array<uint64_t, WordIndex::Stride> makeWeights() {
+		std::array<uint64_t, WordIndex::Stride> weights = {};
+		for (size_t i = 0; i < weights.size(); ++i)
+			weights[i] = mix(i + 1) | 1;
+
+		return weights;
+	}
+
+	constexpr std::array<uint64_t, WordIndex::Stride> weights = makeWeights();
+
+	/**
+	 * Hashes a letter count record
+	 *
+	 * @param counts is the letter count record to hash
+	 * @return hash of the record's signature
+	 */
+	uint64_t hash(_In_reads_(WordIndex::Stride) uint8_t const* counts) {
+		uint64_t result = 0;
+		for (size_t i = 0; i < WordIndex::Stride; ++i)
+			result += weights[i] * counts[i];
+
+		return result;
+	}
+
+	/**
+	 * Picks the first slot to probe for a hash
+	 *
+	 * @param hash is the signature hash
+	 * @param mask is one less than the number of slots
+	 * @return slot to start probing from
+	 */
+	size_t slot(_In_ uint64_t hash, _In_ size_t mask) {
+		return static_cast<size_t>(hash ^ (hash >> 32)) & mask;
+	}
+}
+
+/**
+ * Builds the signature groups for every word in an index
+ *
+ * Words are sorted by signature hash so that each group is a contiguous run,
+ * then every group is inserted into a table that is kept at most three
+ * quarters full.
+ *
+ * @param index is the letter count index of the dictionary
+ */
+SignatureIndex::SignatureIndex(_In_ WordIndex const& index) :
+	tileCount(index.tiles()) {
+	std::vector<std::pair<uint64_t, uint32_t>> keyed(index.size());
+	for (size_t position = 0; position < index.size(); ++position) {
+		uint8_t const* counts = index.counts(position);
+		keyed[position] = { hash(counts), static_cast<uint32_t>(position) };
+
+		int letters = 0;
+		for (size_t i = 0; i < WordIndex::Stride; ++i)
+			letters += counts[i];
+		longest = std::max(longest, letters);
+	}
+
+	std::sort(keyed.begin(), keyed.end());
+
+	size_t groups = 0;
+	std::vector<uint32_t> grouped(keyed.size());
+	for (size_t i = 0; i < keyed.size(); ++i) {
+		grouped[i] = keyed[i].second;
+		if (i == 0 || keyed[i].first != keyed[i - 1].first)
+			++groups;
+	}
+
+	size_t capacity = 16;
+	while (capacity * 3 < groups * 4)
+		capacity *= 2;
+	std::vector<Bucket> table(capacity);
+	mask = capacity - 1;
+
+	for (size_t begin = 0; begin < keyed.size();) {
+		size_t end = begin + 1;
+		while (end < keyed.size() && keyed[end].first == keyed[begin].first)
+			++end;
+
+		size_t position = slot(keyed[begin].first, mask);
+		while (table[position].count)
+			position = (position + 1) & mask;
+		table[position] = { keyed[begin].first,
+			static_cast<uint32_t>(begin), static_cast<uint32_t>(end - begin) };
+
+		begin = end;
+	}
+
+	words = Table<uint32_t>(std::move(grouped));
+	buckets = Table<Bucket>(std::move(table));
+}
+
+/**
+ * Estimates the number of lookups needed to solve a rack
+ *
+ * Every letter in the rack can be used anywhere from zero times up to its
+ * count, and the blanks add a multiset of the alphabet's tiles on top of
+ * that.
+ *
+ * @param rack is the histogram of the available letters
+ * @return number of signatures that would be enumerated
+ */
+double SignatureIndex::estimate(_In_ Rack const& rack) const {
+	double lookups = 1.0;
+	for (size_t i = 0; i < tileCount; ++i)
+		lookups *= rack.counts[i] + 1.0;
+
+	for (int i = 1; i <= rack.blanks; ++i)
+		lookups = lookups * (tileCount - 1.0 + i) / i;
+
+	return lookups;
+}
+
+/**
+ * Finds the words that can be made from a rack
+ *
+ * Signatures are enumerated one letter at a time. A letter is first given
+ * anywhere from zero up to all of its tiles from the rack, and only once all
+ * of them are used may blanks stand in for more of it. This gives every
+ * signature exactly one way to be built, and it is the one with the highest
+ * score. Enumeration stops early once a signature grows longer than any word
+ * in the dictionary. Since different signatures can share a hash, each word
+ * that is found is compared against the enumerated signature before it is
+ * accepted.
+ *
+ * @param dictionary is the word list the index was built from
+ * @param index is the letter count index of the dictionary
+ * @param query contains the letters and filters
+ * @param matches receives the words that can be made
+ */
+void SignatureIndex::find(_In_ Dictionary const& dictionary,
+	_In_ WordIndex const& index, _In_ Query const& query,
+	_Inout_ std::vector<Match>& matches) const {
+	if (buckets.empty())
+		return;
+
+	Rack rack = makeRack(query.letters);
+	uint8_t signature[WordIndex::Stride] = {};
+	size_t lookups = 0;
+
+	int last = static_cast<int>(tileCount);
+	auto visit = [&](auto& self, _In_ int letter, _In_ int total,
+		_In_ int blanks, _In_ int penalty, _In_ uint64_t key) -> void {
+		if (letter == last) {
+			if (!total || (++lookups % 1024 == 0 && isCancelled(query)))
+				return;
+
+			Bucket const* bucket = lookup(key);
+			if (!bucket)
+				return;
+
+			for (uint32_t i = 0; i < bucket->count; ++i) {
+				uint32_t position = words[bucket->begin + i];
+				if (memcmp(index.counts(position), signature,
+					WordIndex::Stride) != 0)
+					continue;
+				if (!passesFilters(query, dictionary[position]))
+					continue;
+
+				matches.push_back({ position,
+					index.score(position) - penalty });
+			}
+
+			return;
+		}
+
+		int tiles = rack.counts[letter];
+		int value = index.values()[letter];
+		for (int used = 0; used <= tiles && total + used <= longest;
+			++used) {
+			signature[letter] = static_cast<uint8_t>(used);
+			uint64_t next = key + weights[letter] * used;
+			if (used < tiles) {
+				self(self, letter + 1, total + used, blanks, penalty, next);
+				continue;
+			}
+
+			for (int extra = 0; extra <= blanks
+				&& total + used + extra <= longest; ++extra) {
+				signature[letter] = static_cast<uint8_t>(used + extra);
+				self(self, letter + 1, total + used + extra, blanks - extra,
+					penalty + value * extra, next + weights[letter] * extra);
+			}
+		}
+
+		signature[letter] = 0;
+	};
+
+	visit(visit, 0, 0, rack.blanks, 0, 0);
+}
+
+/**
+ * Finds the bucket holding a signature hash
+ *
+ * @param hash is the signature hash to look up
+ * @return bucket for the hash, or nullptr if no word has that hash
+ */
+SignatureIndex::Bucket const* SignatureIndex::lookup(
+	_In_ uint64_t hash) const {
+	size_t position = slot(hash, mask);
+	while (buckets[position].count) {
+		if (buckets[position].hash == hash)
+			return &buckets[position];
+		position = (position + 1) & mask;
+	}
+
+	return nullptr;
+}
+
+/**
+ * Checks that every bucket lies within the word list and every word is in
+ * the dictionary, for an index viewed from a lexicon image
+ *
+ * A lookup probes until it reaches an empty bucket, so there has to be one.
+ *
+ * @param positions is the number of words in the dictionary
+ * @return true if the index can be searched safely
+ */
+bool SignatureIndex::intact(_In_ size_t positions) const {
+	for (uint32_t position : words) {
+		if (position >= positions)
+			return false;
+	}
+
+	bool open = buckets.empty();
+	for (Bucket const& bucket : buckets) {
+		if (bucket.begin > words.size()
+			|| bucket.count > words.size() - bucket.begin)
+			return false;
+		open = open || !bucket.count;
+	}
+
+	return open;
+}
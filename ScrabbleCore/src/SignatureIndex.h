@@ -0,0 +1,88 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Anagram signature index for rack lookups without a dictionary scan
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <sal.h>
+
+#include "Dictionary.h"
+#include "Query.h"
+#include "Rack.h"
+#include "Table.h"
+#include "WordIndex.h"
+
+/**
+ * Groups words that are anagrams of each other under a single hash
+ *
+ * A word's signature is its letter histogram, which is the same as its
+ * letters in sorted order. Signatures are hashed as a weighted sum of their
+ * letter counts, so adding a letter to a signature only adds that letter's
+ * weight. A rack is solved by enumerating every sub-histogram of it, with
+ * blanks expanding over every tile of the alphabet, and looking each one up
+ * in an open addressing table.
+ */
+class SignatureIndex {
+public:
+	SignatureIndex() = default;
+
+	/**
+	 * Builds the signature groups for every word in an index
+	 *
+	 * @param index is the letter count index of the dictionary
+	 */
+	explicit SignatureIndex(_In_ WordIndex const& index);
+
+	/**
+	 * Estimates the number of lookups needed to solve a rack
+	 *
+	 * The estimate ignores the length limit, so it is an upper bound.
+	 *
+	 * @param rack is the histogram of the available letters
+	 * @return number of signatures that would be enumerated
+	 */
+	double estimate(_In_ Rack const& rack) const;
+
+	/**
+	 * Finds the words that can be made from a rack
+	 *
+	 * Each word is only found once, using as many of the rack's real letters
+	 * as possible before falling back on blanks, so that its points are as
+	 * high as they can be. Matches are appended in no particular order.
+	 *
+	 * @param dictionary is the word list the index was built from
+	 * @param index is the letter count index of the dictionary
+	 * @param query contains the letters and filters
+	 * @param matches receives the words that can be made
+	 */
+	void find(_In_ Dictionary const& dictionary, _In_ WordIndex const& index,
+		_In_ Query const& query, _Inout_ std::vector<Match>& matches) const;
+
+private:
+	/**
+	 * Range of words that share a signature hash
+	 */
+	struct Bucket {
+		uint64_t hash;
+		uint32_t begin;
+		uint32_t count;
+	};
+
+	friend class LexiconImage;
+
+	Bucket const* lookup(_In_ uint64_t hash) const;
+	bool intact(_In_ size_t positions) const;
+
+	Table<uint32_t> words;
+	Table<Bucket> buckets;
+	size_t mask = 0;
+	int longest = 0;
+	size_t tileCount = 0;
+};
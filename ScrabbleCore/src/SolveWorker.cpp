@@ -0,0 +1,136 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Background thread that solves queries without blocking the caller
+ */
+
+#include "SolveWorker.h"
+
+#include <utility>
+
+namespace {
+	/**
+	 * Last generation handed out by any worker
+	 */
+	std::atomic<uint64_t> generations = 0;
+}
+
+/**
+ * Starts the worker thread
+ *
+ * @param lexicon is the dictionary and indexes to search, which must outlive
+ *        the worker
+ * @param deliver is called with every finished result
+ */
+SolveWorker::SolveWorker(_In_ Lexicon const& lexicon, _In_ Delivery deliver) :
+	lexicon(lexicon), solver(lexicon), deliver(std::move(deliver)),
+	thread(&SolveWorker::work, this) {
+}
+
+/**
+ * Cancels any request in flight and joins the worker thread
+ */
+SolveWorker::~SolveWorker() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+		cancelled = true;
+	}
+
+	wake.notify_one();
+	thread.join();
+}
+
+/**
+ * Queues a request, cancelling the one in flight
+ *
+ * Generations are unique across every worker in the process, so a result
+ * from a worker that has since been replaced is never taken for a current
+ * one.
+ *
+ * @param request is the query to solve
+ * @return generation of the request, which is copied into its result
+ */
+uint64_t SolveWorker::submit(_In_ SolveRequest request) {
+	uint64_t submitted = 0;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending = std::move(request);
+		cancelled = true;
+		generation = ++generations;
+		submitted = generation;
+	}
+
+	wake.notify_one();
+	return submitted;
+}
+
+/**
+ * Solves requests until the worker is destroyed
+ *
+ * The cancellation flag is cleared when a request is taken, under the same
+ * lock that submit() sets it under, so a newer request always cancels the
+ * one that is running. Results of cancelled requests are thrown away and
+ * never cached. A lexicon spelled with another alphabet than the classic
+ * one has every string of a request mapped onto its tiles first.
+ */
+void SolveWorker::work() {
+	while (true) {
+		SolveRequest request;
+		uint64_t current = 0;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this] {
+				return stopping || pending;
+			});
+			if (stopping)
+				return;
+
+			request = std::move(*pending);
+			pending.reset();
+			cancelled = false;
+			current = generation;
+		}
+
+		Alphabet const& alphabet = lexicon.alphabet();
+		if (!alphabet.classic()) {
+			for (std::string* text : { &request.letters, &request.startsWith,
+				&request.endsWith, &request.contains, &request.pattern })
+				*text = alphabet.encode(*text);
+		}
+
+		Query query;
+		query.letters = request.letters;
+		query.startsWith = request.startsWith;
+		query.endsWith = request.endsWith;
+		query.contains = request.contains;
+		std::optional<Pattern> pattern;
+		if (!request.pattern.empty()) {
+			pattern.emplace(request.pattern);
+			query.pattern = &*pattern;
+		}
+
+		query.method = request.method;
+		query.limit = request.limit;
+		query.cancelled = &cancelled;
+
+		std::unique_ptr<SolveResult> result(new SolveResult());
+		result->generation = current;
+		query.profile = &result->profile;
+		if (std::vector<Match> const* cached =
+			cache.find(lexicon.dictionary(), query)) {
+			result->matches = *cached;
+			result->cached = true;
+			result->profile.count(Counter::Matches, cached->size());
+		} else {
+			result->matches = solver.solve(query);
+			if (cancelled)
+				continue;
+
+			cache.insert(query, result->matches);
+		}
+
+		deliver(std::move(result));
+	}
+}
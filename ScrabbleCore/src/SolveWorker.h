@@ -0,0 +1,127 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Background thread that solves queries without blocking the caller
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sal.h>
+
+#include "IncrementalSolver.h"
+#include "Lexicon.h"
+#include "Query.h"
+#include "QueryCache.h"
+#include "Trace.h"
+
+/**
+ * Query whose strings are owned, so it can be handed to another thread
+ *
+ * The strings are in UTF-8 and are mapped onto the lexicon's tiles on the
+ * worker thread, where the pattern is compiled too. An empty pattern means
+ * there is none.
+ */
+struct SolveRequest {
+	std::string letters;
+	std::string startsWith;
+	std::string endsWith;
+	std::string contains;
+	std::string pattern;
+	SortingMethod method = SortingMethod::None;
+	size_t limit = 0;
+};
+
+/**
+ * Outcome of a request that ran to completion
+ *
+ * The profile holds the timings and counters of solving the request, and
+ * only its matches are counted if the result came from the cache.
+ */
+struct SolveResult {
+	uint64_t generation;
+	std::vector<Match> matches;
+	Profile profile;
+	bool cached = false;
+};
+
+/**
+ * Solves one request at a time on its own thread
+ *
+ * Submitting a request cancels the one in flight, and any request that was
+ * still waiting is replaced, so only the most recent one is ever finished.
+ * Recently solved requests are answered from a cache. Finished results are
+ * handed to a delivery function on the worker thread, which for a window
+ * would typically post them back as a message.
+ */
+class SolveWorker {
+public:
+	using Delivery = std::function<void(std::unique_ptr<SolveResult>)>;
+
+	/**
+	 * Starts the worker thread
+	 *
+	 * @param lexicon is the dictionary and indexes to search, which must
+	 *        outlive the worker
+	 * @param deliver is called with every finished result
+	 */
+	SolveWorker(_In_ Lexicon const& lexicon, _In_ Delivery deliver);
+
+	SolveWorker(SolveWorker const&) = delete;
+	SolveWorker& operator=(SolveWorker const&) = delete;
+
+	/**
+	 * Cancels any request in flight and joins the worker thread
+	 */
+	~SolveWorker();
+
+	/**
+	 * Queues a request, cancelling the one in flight
+	 *
+	 * @param request is the query to solve
+	 * @return generation of the request, which is unique within the process
+	 *         and is copied into its result
+	 */
+	uint64_t submit(_In_ SolveRequest request);
+
+	/**
+	 * @return number of requests answered from the result cache
+	 */
+	uint64_t cacheHits() const {
+		return cache.hits();
+	}
+
+	/**
+	 * @return number of requests that had to be solved
+	 */
+	uint64_t cacheMisses() const {
+		return cache.misses();
+	}
+
+private:
+	void work();
+
+	Lexicon const& lexicon;
+	IncrementalSolver solver;
+	QueryCache cache;
+	Delivery deliver;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::optional<SolveRequest> pending;
+	std::atomic<bool> cancelled = false;
+	uint64_t generation = 0;
+	bool stopping = false;
+	std::thread thread;
+};
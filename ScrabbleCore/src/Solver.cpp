@@ -0,0 +1,797 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Scrabble word finder
+ */
+
+#include "Solver.h"
+
+#include <algorithm>
+#include <charconv>
+#include <memory>
+#include <utility>
+
+#include "Rack.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+
+namespace {
+	/**
+	 * Finds words by testing every word in the dictionary
+	 *
+	 * Each word is checked to see if it can be made using the given letters.
+	 * The check only reads the word's record in the index: every letter the
+	 * rack is missing must be covered by a blank. It runs in blocks through
+	 * the vectorized kernel, and the string filters and blank score
+	 * deduction are only applied to words that pass. The dictionary is split
+	 * into chunks that are scanned in parallel by the shared thread pool.
+	 * Each chunk writes into its own slice of one arena buffer sized for
+	 * every word, so no locking or growing is needed, and the slices are
+	 * joined in chunk order so the result does not depend on scheduling.
+	 * When the query is traced, each chunk also fills its own profile, and
+	 * the profiles are merged into the query's afterwards.
+	 *
+	 * @param dictionary is the word list that will be iterated over
+	 * @param index is the letter count index built from the dictionary
+	 * @param query contains the letters and filters
+	 * @param words receives the words that can be made
+	 * @param arena provides the per-chunk buffers
+	 */
+	void scan(_In_ Dictionary const& dictionary, _In_ WordIndex const& index,
+		_In_ Query const& query, _Inout_ std::vector<Match>& words,
+		_Inout_ Arena& arena) {
+		constexpr size_t block = 1024;
+		constexpr size_t chunk = block * 8;
+
+		Rack rack = makeRack(query.letters);
+		size_t chunks = (index.size() + chunk - 1) / chunk;
+		Match* results = arena.allocate<Match>(index.size());
+		size_t* counts = arena.allocate<size_t>(chunks);
+		Profile* profiles = nullptr;
+		if (Tracing && query.profile) {
+			profiles = arena.allocate<Profile>(chunks);
+			std::uninitialized_fill_n(profiles, chunks, Profile());
+		}
+
+		ThreadPool::shared().run(chunks, [&](_In_ size_t number) {
+			size_t& count = counts[number];
+			count = 0;
+			if (isCancelled(query))
+				return;
+
+			Match* result = results + number * chunk;
+			size_t last = std::min((number + 1) * chunk, index.size());
+			Profile* profile = profiles ? profiles + number : nullptr;
+
+			uint32_t feasible[block] = {};
+			for (size_t begin = number * chunk; begin < last; begin += block) {
+				size_t end = std::min(begin + block, last);
+				size_t found = 0;
+				{
+					ScopedTimer timer(profile, Stage::RackCheck);
+					found = findFeasible(index, rack, begin, end, feasible);
+				}
+
+				if (profile) {
+					profile->count(Counter::Scanned, end - begin);
+					profile->count(Counter::RejectedByRack,
+						end - begin - found);
+				}
+
+				ScopedTimer timer(profile, Stage::Filter);
+				for (size_t i = 0; i < found; ++i) {
+					uint32_t position = feasible[i];
+					if (!passesFilters(query, dictionary[position])) {
+						if (profile)
+							profile->reject(query, dictionary[position]);
+						continue;
+					}
+
+					int points = index.score(position);
+					if (rack.blanks)
+						points -= blankPenalty(index.counts(position), rack,
+							index.values());
+					result[count++] = { position, points };
+				}
+			}
+		});
+
+		for (size_t number = 0; profiles && number < chunks; ++number)
+			query.profile->merge(profiles[number]);
+
+		size_t total = words.size();
+		for (size_t number = 0; number < chunks; ++number)
+			total += counts[number];
+
+		words.reserve(total);
+		for (size_t number = 0; number < chunks; ++number) {
+			Match const* result = results + number * chunk;
+			words.insert(words.end(), result, result + counts[number]);
+		}
+	}
+
+	/**
+	 * Finds the words that run through tiles on the board by testing every
+	 * word in the dictionary
+	 *
+	 * Every place in a word where the tiles fit is tried, and the rest of
+	 * the word is paid for by the rack the way the GADDAG pays for it, so
+	 * the best score of all the places is kept and both find the same
+	 * words with the same points.
+	 *
+	 * @param dictionary is the word list that will be iterated over
+	 * @param index is the letter count index built from the dictionary,
+	 *        which holds the point values of its tiles
+	 * @param query contains the letters, filters and tiles on the board
+	 * @param words receives the words that can be made, in dictionary order
+	 */
+	void scanThrough(_In_ Dictionary const& dictionary,
+		_In_ WordIndex const& index, _In_ Query const& query,
+		_Inout_ std::vector<Match>& words) {
+		std::string_view tiles = query.through;
+		bool anywhere = query.offset == Gaddag::Anywhere;
+		for (size_t position = 0; position < dictionary.size(); ++position) {
+			if (position % 4096 == 0 && isCancelled(query))
+				return;
+
+			std::string_view word = dictionary[position];
+			if (word.length() < tiles.length() + (query.hook ? 1 : 0)
+				|| !passesFilters(query, word))
+				continue;
+
+			size_t room = word.length() - tiles.length();
+			size_t last = anywhere ? room : std::min(query.offset, room);
+			int best = -1;
+			for (size_t start = anywhere ? 0 : query.offset; start <= last;
+				++start) {
+				size_t i = 0;
+				while (i < tiles.length()
+					&& upper(word[start + i]) == upper(tiles[i]))
+					++i;
+				if (i < tiles.length())
+					continue;
+
+				RackSpender rack(query.letters, index);
+				int total = 0;
+				for (i = 0; i < word.length(); ++i) {
+					int points = 0;
+					if (i >= start && i < start + tiles.length()) {
+						char tile = tiles[i - start];
+						int code = rack.tileOf(tile);
+						if (code >= 0 && (tile < 'a' || tile > 'z'))
+							total += rack.value(code);
+					} else if (rack.spend(word[i], points))
+						total += std::max(points, 0);
+					else
+						break;
+				}
+
+				if (i == word.length())
+					best = std::max(best, total);
+			}
+
+			if (best >= 0)
+				words.push_back({ static_cast<uint32_t>(position), best });
+		}
+	}
+
+	/**
+	 * Finds words by testing only the candidates from an index
+	 *
+	 * The substring index resolves the ends with and contains filters, and
+	 * the bitset index rules out the words with too many of a letter or too
+	 * many tiles for the rack, or too few of the letters in the filters. The
+	 * rack and filters are then only checked against the words that remain.
+	 * When the query is traced, the index lookup counts as the filter stage
+	 * and the checks of the candidates as the rack check.
+	 *
+	 * @param lexicon is the dictionary and indexes that will be searched
+	 * @param query contains the letters and filters
+	 * @param engine is the substring or bitset engine, naming the index
+	 * @param words receives the words that can be made
+	 * @param candidates is emptied and used to hold the candidates
+	 */
+	void filter(_In_ Lexicon const& lexicon, _In_ Query const& query,
+		_In_ Engine engine, _Inout_ std::vector<Match>& words,
+		_Inout_ std::vector<uint32_t>& candidates) {
+		Dictionary const& dictionary = lexicon.dictionary();
+		WordIndex const& index = lexicon.index();
+		Rack rack = makeRack(query.letters);
+		Profile* profile = Tracing ? query.profile : nullptr;
+
+		candidates.clear();
+		{
+			ScopedTimer timer(profile, Stage::Filter);
+			if (engine == Engine::Bitset)
+				lexicon.bitsets().find(query, candidates);
+			else
+				lexicon.substrings().find(dictionary, query, candidates);
+		}
+
+		ScopedTimer timer(profile, Stage::RackCheck);
+		if (profile)
+			profile->count(Counter::Scanned, candidates.size());
+
+		for (size_t i = 0; i < candidates.size(); ++i) {
+			if (i % 4096 == 0 && isCancelled(query))
+				return;
+
+			uint32_t position = candidates[i];
+			uint8_t const* counts = index.counts(position);
+			if (!isFeasible(counts, rack)) {
+				if (profile)
+					profile->count(Counter::RejectedByRack);
+				continue;
+			}
+
+			if (!passesFilters(query, dictionary[position])) {
+				if (profile)
+					profile->reject(query, dictionary[position]);
+				continue;
+			}
+
+			int points = index.score(position);
+			if (rack.blanks)
+				points -= blankPenalty(counts, rack, index.values());
+			words.push_back({ position, points });
+		}
+	}
+
+	/**
+	 * Sorts matches as packed integer keys
+	 *
+	 * In a sorted dictionary, a match's place in either order is fully
+	 * described by its points, length and position. These are packed into a
+	 * single integer per match, most significant field first, and the
+	 * integers are sorted instead of comparing words. When sorting by length,
+	 * the points go below the position, which is unique, so they are carried
+	 * along without affecting the order. Points that do not fit in 16 bits and
+	 * lengths that do not fit in 8 bits cannot be packed.
+	 *
+	 * @param dictionary is the word list the matches were found in
+	 * @param method is the sorting method used for the list
+	 * @param matches is the list of matches to sort
+	 * @param keys has room for one key per match
+	 * @return false if the matches could not be packed and were left as is
+	 */
+	bool sortPacked(_In_ Dictionary const& dictionary,
+		_In_ SortingMethod method, _Inout_ std::vector<Match>& matches,
+		_Out_writes_(matches.size()) uint64_t* keys) {
+		if (!dictionary.sorted())
+			return false;
+
+		bool points = method != SortingMethod::Length;
+		for (size_t i = 0; i < matches.size(); ++i) {
+			Match const& match = matches[i];
+			size_t length = dictionary[match.index].length();
+			if (match.points < 0 || match.points > UINT16_MAX
+				|| length > UINT8_MAX)
+				return false;
+
+			uint64_t score = static_cast<uint64_t>(match.points);
+			if (points)
+				keys[i] = score << 40 | static_cast<uint64_t>(length) << 32
+					| match.index;
+			else
+				keys[i] = static_cast<uint64_t>(length) << 48
+					| static_cast<uint64_t>(match.index) << 16 | score;
+		}
+
+		std::sort(keys, keys + matches.size());
+		for (size_t i = 0; i < matches.size(); ++i) {
+			uint64_t key = keys[i];
+			if (points)
+				matches[i] = { static_cast<uint32_t>(key),
+					static_cast<int>(key >> 40) };
+			else
+				matches[i] = { static_cast<uint32_t>(key >> 16),
+					static_cast<int>(key & UINT16_MAX) };
+		}
+
+		return true;
+	}
+
+	/**
+	 * Sorts a list of matches, packing their keys into a given buffer
+	 *
+	 * @param dictionary is the word list the matches were found in
+	 * @param method is the sorting method used for the list
+	 * @param matches is the list of matches to sort
+	 * @param keys has room for one key per match
+	 */
+	void sortWith(_In_ Dictionary const& dictionary,
+		_In_ SortingMethod method, _Inout_ std::vector<Match>& matches,
+		_Out_writes_(matches.size()) uint64_t* keys) {
+		if (method == SortingMethod::None)
+			return;
+		if (sortPacked(dictionary, method, matches, keys))
+			return;
+
+		std::sort(matches.begin(), matches.end(),
+			MatchOrder(dictionary, method));
+	}
+
+	/**
+	 * Puts a query's matches in the order it asks for
+	 *
+	 * @param dictionary is the word list the matches were found in
+	 * @param query contains the sorting method and limit
+	 * @param words is the list of matches to order
+	 * @param arena optionally provides the sort keys, which are allocated
+	 *        on the heap otherwise
+	 */
+	void arrange(_In_ Dictionary const& dictionary, _In_ Query const& query,
+		_Inout_ std::vector<Match>& words, _Inout_opt_ Arena* arena) {
+		if (query.limit)
+			selectBest(dictionary, query.method, query.limit, words);
+		else if (arena)
+			sortWith(dictionary, query.method, words,
+				arena->allocate<uint64_t>(words.size()));
+		else
+			sortMatches(dictionary, query.method, words);
+	}
+
+	/**
+	 * Writes the text shown for a list of matches
+	 *
+	 * @param dictionary is the word list the matches were found in
+	 * @param matches is the list of matches to output, which must not be
+	 *        empty
+	 * @param output has room for the length returned by textLength()
+	 * @return number of characters written
+	 */
+	size_t writeText(_In_ Dictionary const& dictionary,
+		_In_ MatchSpan matches, _Out_ char* output) {
+		char* next = output;
+		for (Match const& match : matches) {
+			if (next != output) {
+				*next++ = '\r';
+				*next++ = '\n';
+			}
+
+			std::string_view word = dictionary[match.index];
+			next = std::copy(word.begin(), word.end(), next);
+			*next++ = ' ';
+			*next++ = '(';
+			next = std::to_chars(next, next + 11, match.points).ptr;
+			*next++ = ')';
+		}
+
+		return static_cast<size_t>(next - output);
+	}
+
+	/**
+	 * @param dictionary is the word list the matches were found in
+	 * @param matches is the list of matches to output
+	 * @return upper bound on the length of the text for the matches, which
+	 *         allows for a line break and the longest possible points
+	 */
+	size_t textLength(_In_ Dictionary const& dictionary,
+		_In_ MatchSpan matches) {
+		size_t length = 0;
+		for (Match const& match : matches)
+			length += dictionary[match.index].length() + 16;
+
+		return length;
+	}
+
+	/**
+	 * Finds words for many queries in one pass over the dictionary
+	 *
+	 * The index is walked in blocks small enough to stay in cache, and each
+	 * block is tested against a whole tile of racks before moving on, so a
+	 * record is read from memory once per tile instead of once per query.
+	 * Tiles run in parallel on the shared thread pool. When there are too
+	 * few tiles to keep every thread busy, the dictionary is also split into
+	 * parts, and each query's lists are joined in part order afterwards.
+	 *
+	 * @param lexicon is the dictionary and indexes that will be searched
+	 * @param queries is the whole batch
+	 * @param selected holds the positions of the queries to scan
+	 * @param results receives the words of each scanned query, unsorted, at
+	 *        the query's position
+	 */
+	void scanBatch(_In_ Lexicon const& lexicon,
+		_In_ std::vector<Query> const& queries,
+		_In_ std::vector<size_t> const& selected,
+		_Inout_ std::vector<std::vector<Match>>& results) {
+		constexpr size_t block = 1024;
+		constexpr size_t tile = 32;
+
+		Dictionary const& dictionary = lexicon.dictionary();
+		WordIndex const& index = lexicon.index();
+		if (selected.empty() || !index.size())
+			return;
+
+		std::vector<Rack> racks(selected.size());
+		for (size_t i = 0; i < selected.size(); ++i)
+			racks[i] = makeRack(queries[selected[i]].letters);
+
+		ThreadPool& pool = ThreadPool::shared();
+		size_t tiles = (selected.size() + tile - 1) / tile;
+		size_t blocks = (index.size() + block - 1) / block;
+		size_t parts = std::min(blocks, (pool.size() * 2 + tiles - 1) / tiles);
+		size_t span = (blocks + parts - 1) / parts * block;
+		parts = (index.size() + span - 1) / span;
+
+		std::vector<std::vector<Match>> found(parts * selected.size());
+		pool.run(tiles * parts, [&](_In_ size_t task) {
+			size_t first = task / parts * tile;
+			size_t last = std::min(first + tile, selected.size());
+			size_t part = task % parts;
+			size_t end = std::min((part + 1) * span, index.size());
+
+			uint32_t feasible[block] = {};
+			for (size_t begin = part * span; begin < end; begin += block) {
+				size_t stop = std::min(begin + block, end);
+				for (size_t i = first; i < last; ++i) {
+					Query const& query = queries[selected[i]];
+					if (isCancelled(query))
+						continue;
+
+					Rack const& rack = racks[i];
+					std::vector<Match>& words =
+						found[part * selected.size() + i];
+					size_t count = findFeasible(index, rack, begin, stop,
+						feasible);
+					for (size_t j = 0; j < count; ++j) {
+						uint32_t position = feasible[j];
+						if (!passesFilters(query, dictionary[position]))
+							continue;
+
+						int points = index.score(position);
+						if (rack.blanks)
+							points -= blankPenalty(index.counts(position),
+								rack, index.values());
+						words.push_back({ position, points });
+					}
+				}
+			}
+		});
+
+		for (size_t i = 0; i < selected.size(); ++i) {
+			std::vector<Match>& words = results[selected[i]];
+			size_t total = 0;
+			for (size_t part = 0; part < parts; ++part)
+				total += found[part * selected.size() + i].size();
+
+			words.reserve(total);
+			for (size_t part = 0; part < parts; ++part) {
+				std::vector<Match> const& list =
+					found[part * selected.size() + i];
+				words.insert(words.end(), list.begin(), list.end());
+			}
+		}
+	}
+}
+
+/**
+ * Picks the engine that will solve a query
+ *
+ * Queries with a starts with filter walk the word graph from the end of the
+ * prefix, and so do queries with a pattern that rules out most first
+ * letters, since the pattern prunes the walk from the root. Queries with a
+ * contains filter walk the GADDAG outward from the fragment, but only once
+ * something else has paid for building it.
+ * Selective ends with and contains filters only check the candidates found
+ * in the substring index, unless the bitset index narrows the search down
+ * further. Otherwise, small racks are solved by looking up every signature
+ * they can spell, and filters that leave few words with the letter and
+ * tile counts the rack allows only check the candidates from the bitset
+ * index. Racks with many blanks are solved by scanning the whole
+ * dictionary, and the rest by walking the word graph. Indexes that
+ * are still being built are passed over, and a query asking for one of
+ * them falls back to the scan, which is always available. So does a query
+ * asking for the signature lookup with a rack that can spell more
+ * signatures than there are words, as with many blanks. Queries with tiles
+ * on the board are only understood by the GADDAG and by the scan, so they
+ * walk the GADDAG unless the scan is asked for or the word graph the GADDAG
+ * maps its words back with is not ready.
+ *
+ * @param lexicon is the dictionary and indexes that will be searched
+ * @param query contains the letters, filters and engine
+ * @return engine asked for by the query unless it is unavailable or would
+ *         be far slower than the scan, or the one expected to be fastest
+ *         if the query leaves it to the solver
+ */
+Engine selectEngine(_In_ Lexicon const& lexicon, _In_ Query const& query) {
+	if (!query.through.empty())
+		return query.engine != Engine::Scan && lexicon.ready(Engine::Gaddag)
+			? Engine::Gaddag : Engine::Scan;
+
+	Rack rack = makeRack(query.letters);
+	if (query.engine == Engine::Signature && lexicon.ready(Engine::Signature)
+		&& lexicon.signatures().estimate(rack)
+		> static_cast<double>(lexicon.index().size()))
+		return Engine::Scan;
+	if (query.engine != Engine::Automatic)
+		return lexicon.ready(query.engine) ? query.engine : Engine::Scan;
+
+	bool dawg = lexicon.ready(Engine::Dawg);
+	if (!query.startsWith.empty() && dawg)
+		return Engine::Dawg;
+	if (query.pattern && query.pattern->anchored() && dawg)
+		return Engine::Dawg;
+	if (!query.contains.empty() && dawg && lexicon.hasGaddag())
+		return Engine::Gaddag;
+
+	size_t size = lexicon.index().size();
+	size_t fragments = lexicon.ready(Engine::Substring)
+		? lexicon.substrings().estimate(lexicon.dictionary(), query) : size;
+	size_t postings = lexicon.ready(Engine::Bitset)
+		? lexicon.bitsets().estimate(query) : size;
+	if (fragments * 16 < size)
+		return postings * 2 < fragments ? Engine::Bitset : Engine::Substring;
+	if (lexicon.ready(Engine::Signature)
+		&& lexicon.signatures().estimate(rack) * 32.0
+		< static_cast<double>(size))
+		return Engine::Signature;
+	if (postings * 8 < size
+		&& (!query.endsWith.empty() || !query.contains.empty()))
+		return Engine::Bitset;
+	if (rack.blanks > 2 || !dawg)
+		return Engine::Scan;
+	return Engine::Dawg;
+}
+
+/**
+ * Finds words that can be made from a list of letters
+ *
+ * Takes in a list of letters and a lexicon. Blank letters are represented using
+ * a question mark. The engine is the one asked for by the query, or else the
+ * one picked by selectEngine(). Afterwards, the words
+ * that can be made are sorted by the query's sorting method, or, if the query
+ * has a limit, only that many of the best words are kept. The dictionary is
+ * only borrowed and words are referred to by index, so nothing is copied. A
+ * cancelled query returns no words.
+ *
+ * @param lexicon is the dictionary and indexes that will be searched
+ * @param query contains the letters, filters, sorting method, engine and
+ *        limit
+ * @return matching words in the order given by the sorting method, or the
+ *         best matching words from best to worst if the query has a limit
+ */
+std::vector<Match> solve(_In_ Lexicon const& lexicon,
+	_In_ Query const& query) {
+	Workspace workspace;
+	solve(lexicon, query, workspace);
+	return std::move(workspace.matches);
+}
+
+/**
+ * Finds words that can be made from a list of letters, reusing memory
+ *
+ * Works like the other overload, except that the matches are gathered in
+ * the workspace, and the scratch memory of every engine comes from its
+ * arena, which is reset first. Once the workspace has grown to fit the
+ * queries it is given, solving makes no heap allocations, except through the
+ * GADDAG, which builds its words in strings of its own. A traced query
+ * records the engine, the time spent searching and sorting, and the number
+ * of matches.
+ *
+ * @param lexicon is the dictionary and indexes that will be searched
+ * @param query contains the letters, filters, sorting method, engine and
+ *        limit
+ * @param workspace holds the memory reused from one query to the next
+ * @return matching words in the order given by the sorting method, or the
+ *         best matching words from best to worst if the query has a limit,
+ *         which stay valid until the workspace is used again
+ */
+MatchSpan solve(_In_ Lexicon const& lexicon, _In_ Query const& query,
+	_Inout_ Workspace& workspace) {
+	workspace.memory.reset();
+	std::vector<Match>& words = workspace.matches;
+	words.clear();
+
+	Profile* profile = Tracing ? query.profile : nullptr;
+	Engine engine = selectEngine(lexicon, query);
+	if (profile)
+		profile->use(engine);
+
+	{
+		ScopedTimer search(profile, Stage::Search);
+		switch (engine) {
+			case Engine::Signature:
+				lexicon.signatures().find(lexicon.dictionary(), lexicon.index(),
+					query, words);
+				break;
+			case Engine::Dawg:
+				lexicon.dawg().find(lexicon.index(), query, words,
+					&workspace.word);
+				break;
+			case Engine::Substring:
+			case Engine::Bitset:
+				filter(lexicon, query, engine, words, workspace.candidates);
+				break;
+			case Engine::Gaddag:
+				lexicon.gaddag().find(lexicon.dawg(), lexicon.index(), query,
+					words);
+				break;
+			default:
+				if (query.through.empty())
+					scan(lexicon.dictionary(), lexicon.index(), query, words,
+						workspace.memory);
+				else
+					scanThrough(lexicon.dictionary(), lexicon.index(), query,
+						words);
+				break;
+		}
+	}
+
+	if (isCancelled(query)) {
+		words.clear();
+		return {};
+	}
+
+	{
+		ScopedTimer sort(profile, Stage::Sort);
+		arrange(lexicon.dictionary(), query, words, &workspace.memory);
+	}
+
+	if (profile)
+		profile->count(Counter::Matches, words.size());
+	return words;
+}
+
+/**
+ * Finds words for many queries at once
+ *
+ * Every query that would scan the dictionary on its own is solved in a
+ * single tiled pass, which tests each block of the index against many racks
+ * while it is in cache. The remaining queries use the engines picked for
+ * them, spread over the shared thread pool. Each query's words are then put
+ * in the order it asks for. A cancelled query returns no words. Queries
+ * solved in the shared pass are not traced, since their work is mixed with
+ * the rest of the batch.
+ *
+ * @param lexicon is the dictionary and indexes that will be searched
+ * @param queries contains the letters, filters, sorting method, engine and
+ *        limit of every query
+ * @return matching words of each query, at the query's position
+ */
+std::vector<std::vector<Match>> solveBatch(_In_ Lexicon const& lexicon,
+	_In_ std::vector<Query> const& queries) {
+	std::vector<std::vector<Match>> results(queries.size());
+	std::vector<Engine> engines(queries.size());
+	std::vector<size_t> scanned;
+	std::vector<size_t> separate;
+	for (size_t i = 0; i < queries.size(); ++i) {
+		engines[i] = selectEngine(lexicon, queries[i]);
+		if (engines[i] == Engine::Scan && queries[i].through.empty())
+			scanned.push_back(i);
+		else
+			separate.push_back(i);
+	}
+
+	ThreadPool& pool = ThreadPool::shared();
+	pool.run(separate.size(), [&](_In_ size_t task) {
+		size_t i = separate[task];
+		Query query = queries[i];
+		query.engine = engines[i];
+		results[i] = solve(lexicon, query);
+	});
+
+	scanBatch(lexicon, queries, scanned, results);
+	pool.run(scanned.size(), [&](_In_ size_t task) {
+		size_t i = scanned[task];
+		if (isCancelled(queries[i]))
+			results[i].clear();
+		else
+			arrange(lexicon.dictionary(), queries[i], results[i], nullptr);
+	});
+
+	return results;
+}
+
+/**
+ * Sorts a list of matches
+ *
+ * Matches from a sorted dictionary are sorted as packed integer keys, and
+ * the rest by comparing their words.
+ *
+ * @param dictionary is the word list the matches were found in
+ * @param method is the sorting method used for the list
+ * @param matches is the list of matches to sort
+ */
+void sortMatches(_In_ Dictionary const& dictionary,
+	_In_ SortingMethod method, _Inout_ std::vector<Match>& matches) {
+	if (method == SortingMethod::None)
+		return;
+
+	std::vector<uint64_t> keys(matches.size());
+	sortWith(dictionary, method, matches, keys.data());
+}
+
+/**
+ * Keeps only the best matches of a list
+ *
+ * Selection keeps a heap of the best matches seen so far, bounded by the
+ * limit, so only the matches that are kept end up fully sorted.
+ *
+ * @param dictionary is the word list the matches were found in
+ * @param method is the sorting method to rank by
+ * @param limit is the number of matches to keep
+ * @param matches is the list of matches, which is left holding the best
+ *        matches from best to worst
+ */
+void selectBest(_In_ Dictionary const& dictionary, _In_ SortingMethod method,
+	_In_ size_t limit, _Inout_ std::vector<Match>& matches) {
+	MatchOrder order(dictionary, method);
+	auto better = [&order](_In_ Match const& a, _In_ Match const& b) {
+		return order(b, a);
+	};
+
+	limit = std::min(limit, matches.size());
+	std::partial_sort(matches.begin(), matches.begin() + limit, matches.end(),
+		better);
+	matches.resize(limit);
+}
+
+/**
+ * Builds a heap out of a list of matches
+ *
+ * @param dictionary is the word list the matches were found in
+ * @param method is the sorting method to rank by
+ * @param matches is the list of matches to hand out
+ */
+MatchStream::MatchStream(_In_ Dictionary const& dictionary,
+	_In_ SortingMethod method, _In_ std::vector<Match> matches) :
+	order(dictionary, method), heap(std::move(matches)) {
+	std::make_heap(heap.begin(), heap.end(), order);
+}
+
+/**
+ * Takes the best match that is left
+ *
+ * @param match receives the best match that is left
+ * @return false if every match has already been taken
+ */
+bool MatchStream::next(_Out_ Match& match) {
+	if (heap.empty())
+		return false;
+
+	std::pop_heap(heap.begin(), heap.end(), order);
+	match = heap.back();
+	heap.pop_back();
+	return true;
+}
+
+/**
+ * Builds the text shown for a list of matches
+ *
+ * The words are only read from the dictionary at this point. The length of
+ * the output is computed up front so the string is allocated once.
+ *
+ * @param dictionary is the word list the matches were found in
+ * @param matches is the list of matches to output
+ * @return string containing one word and its points per line
+ */
+std::string format(_In_ Dictionary const& dictionary,
+	_In_ MatchSpan matches) {
+	if (matches.empty())
+		return "No results";
+
+	std::string results(textLength(dictionary, matches), '\0');
+	results.resize(writeText(dictionary, matches, results.data()));
+	return results;
+}
+
+/**
+ * Builds the text shown for a list of matches in a workspace's arena
+ *
+ * @param dictionary is the word list the matches were found in
+ * @param matches is the list of matches to output
+ * @param workspace provides the memory for the text
+ * @return text containing one word and its points per line, which stays
+ *         valid until the workspace is used to solve another query
+ */
+std::string_view format(_In_ Dictionary const& dictionary,
+	_In_ MatchSpan matches, _Inout_ Workspace& workspace) {
+	if (matches.empty())
+		return "No results";
+
+	char* text = workspace.memory.allocate<char>(textLength(dictionary,
+		matches));
+	return std::string_view(text, writeText(dictionary, matches, text));
+}
@@ -0,0 +1,257 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Scrabble word finder
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sal.h>
+
+#include "Arena.h"
+#include "Dictionary.h"
+#include "Lexicon.h"
+#include "Query.h"
+#include "Scoring.h"
+
+/**
+ * Converts a letter into its corresponding point value
+ *
+ * @param letter that will be converted into a point value
+ * @return point value of the given letter in the standard tile set
+ */
+inline int convert(_In_ char const letter) {
+	return LetterScores<TileSet::Standard>[static_cast<unsigned char>(
+		letter)];
+}
+
+/**
+ * Calculates a word into its total point value
+ *
+ * @param word is a string containing the word to be calculated
+ * @return point total of the given word in the standard tile set
+ */
+inline int calculate(_In_ std::string_view word) {
+	return scoreWord<TileSet::Standard>(word);
+}
+
+/**
+ * Picks the engine that will solve a query
+ *
+ * @param lexicon is the dictionary and indexes that will be searched
+ * @param query contains the letters, filters and engine
+ * @return engine asked for by the query unless it is unavailable or would
+ *         be far slower than the scan, or the one expected to be fastest
+ *         if the query leaves it to the solver
+ */
+Engine selectEngine(_In_ Lexicon const& lexicon, _In_ Query const& query);
+
+/**
+ * Memory reused by every query solved through it
+ *
+ * Holds the arena that each query's scratch memory comes from, along with
+ * the lists a query's results are gathered in, which keep their capacity
+ * from one query to the next. Once a workspace has seen queries as large as
+ * the ones it is given, solving through it makes no heap allocations. A
+ * workspace may only be used by one thread at a time.
+ */
+class Workspace {
+public:
+	/**
+	 * @param capacity is the number of bytes to reserve in the arena up
+	 *        front
+	 */
+	explicit Workspace(_In_ size_t capacity = 0) : memory(capacity) {
+	}
+
+	/**
+	 * @return arena the scratch memory of each query comes from
+	 */
+	Arena const& arena() const {
+		return memory;
+	}
+
+private:
+	friend std::vector<Match> solve(_In_ Lexicon const& lexicon,
+		_In_ Query const& query);
+	friend MatchSpan solve(_In_ Lexicon const& lexicon,
+		_In_ Query const& query, _Inout_ Workspace& workspace);
+	friend std::string_view format(_In_ Dictionary const& dictionary,
+		_In_ MatchSpan matches, _Inout_ Workspace& workspace);
+
+	Arena memory;
+	std::vector<Match> matches;
+	std::vector<uint32_t> candidates;
+	std::string word;
+};
+
+/**
+ * Finds words that can be made from a list of letters
+ *
+ * @param lexicon is the dictionary and indexes that will be searched
+ * @param query contains the letters, filters, sorting method, engine and
+ *        limit
+ * @return matching words in the order given by the sorting method, or the
+ *         best matching words from best to worst if the query has a limit
+ */
+std::vector<Match> solve(_In_ Lexicon const& lexicon,
+	_In_ Query const& query);
+
+/**
+ * Finds words that can be made from a list of letters, reusing memory
+ *
+ * @param lexicon is the dictionary and indexes that will be searched
+ * @param query contains the letters, filters, sorting method, engine and
+ *        limit
+ * @param workspace holds the memory reused from one query to the next
+ * @return matching words in the order given by the sorting method, or the
+ *         best matching words from best to worst if the query has a limit,
+ *         which stay valid until the workspace is used again
+ */
+MatchSpan solve(_In_ Lexicon const& lexicon, _In_ Query const& query,
+	_Inout_ Workspace& workspace);
+
+/**
+ * Finds words for many queries at once
+ *
+ * Gives the same results as solving each query in turn, but racks that
+ * would each scan the whole dictionary share a single pass over it.
+ *
+ * @param lexicon is the dictionary and indexes that will be searched
+ * @param queries contains the letters, filters, sorting method, engine and
+ *        limit of every query
+ * @return matching words of each query, at the query's position
+ */
+std::vector<std::vector<Match>> solveBatch(_In_ Lexicon const& lexicon,
+	_In_ std::vector<Query> const& queries);
+
+/**
+ * Ordering of matches from worst to best under a sorting method
+ *
+ * Sorting by points orders words from lowest to highest score, then by
+ * length and alphabetically. Sorting by length skips the score. Matches that
+ * are not sorted are ranked as if sorted by points. Matches are compared by
+ * reference and words are only viewed in the dictionary, so comparing copies
+ * nothing. In a sorted dictionary, alphabetical order is the order of the
+ * positions, so words are not compared at all.
+ */
+class MatchOrder {
+public:
+	/**
+	 * @param dictionary is the word list the matches were found in
+	 * @param method is the sorting method to order by
+	 */
+	MatchOrder(_In_ Dictionary const& dictionary, _In_ SortingMethod method) :
+		dictionary(&dictionary), method(method) {
+	}
+
+	/**
+	 * @param a is the first match to compare
+	 * @param b is the second match to compare
+	 * @return true if a comes before b
+	 */
+	bool operator()(_In_ Match const& a, _In_ Match const& b) const {
+		if (method != SortingMethod::Length && a.points != b.points)
+			return a.points < b.points;
+
+		std::string_view first = (*dictionary)[a.index];
+		std::string_view second = (*dictionary)[b.index];
+		if (first.length() != second.length())
+			return first.length() < second.length();
+		if (dictionary->sorted())
+			return a.index < b.index;
+
+		return first < second;
+	}
+
+private:
+	Dictionary const* dictionary;
+	SortingMethod method;
+};
+
+/**
+ * Hands out matches from best to worst without sorting all of them
+ *
+ * The matches are turned into a heap up front in linear time, and each match
+ * taken off costs a logarithmic number of comparisons, so a caller that only
+ * reads the first few matches never pays for the rest.
+ */
+class MatchStream {
+public:
+	/**
+	 * @param dictionary is the word list the matches were found in
+	 * @param method is the sorting method to rank by
+	 * @param matches is the list of matches to hand out
+	 */
+	MatchStream(_In_ Dictionary const& dictionary, _In_ SortingMethod method,
+		_In_ std::vector<Match> matches);
+
+	/**
+	 * Takes the best match that is left
+	 *
+	 * @param match receives the best match that is left
+	 * @return false if every match has already been taken
+	 */
+	bool next(_Out_ Match& match);
+
+	/**
+	 * @return number of matches that are left
+	 */
+	size_t size() const {
+		return heap.size();
+	}
+
+private:
+	MatchOrder order;
+	std::vector<Match> heap;
+};
+
+/**
+ * Sorts a list of matches
+ *
+ * @param dictionary is the word list the matches were found in
+ * @param method is the sorting method used for the list
+ * @param matches is the list of matches to sort
+ */
+void sortMatches(_In_ Dictionary const& dictionary,
+	_In_ SortingMethod method, _Inout_ std::vector<Match>& matches);
+
+/**
+ * Keeps only the best matches of a list
+ *
+ * @param dictionary is the word list the matches were found in
+ * @param method is the sorting method to rank by
+ * @param limit is the number of matches to keep
+ * @param matches is the list of matches, which is left holding the best
+ *        matches from best to worst
+ */
+void selectBest(_In_ Dictionary const& dictionary, _In_ SortingMethod method,
+	_In_ size_t limit, _Inout_ std::vector<Match>& matches);
+
+/**
+ * Builds the text shown for a list of matches
+ *
+ * @param dictionary is the word list the matches were found in
+ * @param matches is the list of matches to output
+ * @return string containing one word and its points per line
+ */
+std::string format(_In_ Dictionary const& dictionary,
+	_In_ MatchSpan matches);
+
+/**
+ * Builds the text shown for a list of matches in a workspace's arena
+ *
+ * @param dictionary is the word list the matches were found in
+ * @param matches is the list of matches to output
+ * @param workspace provides the memory for the text
+ * @return text containing one word and its points per line, which stays
+ *         valid until the workspace is used to solve another query
+ */
+std::string_view format(_In_ Dictionary const& dictionary,
+	_In_ MatchSpan matches, _Inout_ Workspace& workspace);
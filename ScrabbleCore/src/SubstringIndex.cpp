@@ -0,0 +1,255 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Suffix and substring index for the ends with and contains filters
+ */
+
+#include "SubstringIndex.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+#include "Alphabet.h"
+
+namespace {
+	/**
+	 * Number of pairs of adjacent tiles that have a posting list
+	 */
+	constexpr size_t Pairs = Alphabet::MaxTiles * Alphabet::MaxTiles;
+
+	/**
+	 * Compares the end of a word to a suffix, reading both backwards
+	 *
+	 * @param word is the word to compare
+	 * @param ending is the suffix to compare against
+	 * @return zero if the word ends with the suffix, otherwise negative or
+	 *         positive depending on how the reversed word sorts against it
+	 */
+	int compareEnding(_In_ std::string_view word,
+		_In_ std::string_view ending) {
+		size_t length = std::min(word.length(), ending.length());
+		for (size_t i = 1; i <= length; ++i) {
+			unsigned char a = static_cast<unsigned char>(
+				upper(word[word.length() - i]));
+			unsigned char b = static_cast<unsigned char>(
+				upper(ending[ending.length() - i]));
+			if (a != b)
+				return a < b ? -1 : 1;
+		}
+
+		return word.length() < ending.length() ? -1 : 0;
+	}
+}
+
+/**
+ * Builds the suffix list and letter pair postings for a dictionary
+ *
+ * The postings are built in two passes, first counting and then filling, so
+ * that every list sits in a single array. A pair that appears more than once
+ * in a word is only posted once.
+ *
+ * @param dictionary is the word list to index
+ */
+SubstringIndex::SubstringIndex(_In_ Dictionary const& dictionary) {
+	std::vector<uint32_t> endings(dictionary.size());
+	std::vector<uint32_t> starts(Pairs + 1);
+	std::vector<uint32_t> lists;
+	std::iota(endings.begin(), endings.end(), 0);
+	std::sort(endings.begin(), endings.end(), [&dictionary](
+		_In_ uint32_t a, _In_ uint32_t b) {
+			std::string_view first = dictionary[a];
+			std::string_view second = dictionary[b];
+			int order = compareEnding(first, second);
+			if (order == 0 && first.length() != second.length())
+				return false;
+			return order != 0 ? order < 0 : a < b;
+		});
+
+	std::vector<uint32_t> seen(Pairs, UINT32_MAX);
+	for (int pass = 0; pass < 2; ++pass) {
+		std::vector<uint32_t> next(starts.begin(), starts.end() - 1);
+		std::fill(seen.begin(), seen.end(), UINT32_MAX);
+		for (size_t position = 0; position < dictionary.size(); ++position) {
+			std::string_view word = dictionary[position];
+			for (size_t i = 1; i < word.length(); ++i) {
+				int first = Alphabet::tileOf(word[i - 1]);
+				int second = Alphabet::tileOf(word[i]);
+				if (first < 0 || second < 0)
+					continue;
+
+				size_t key = first * Alphabet::MaxTiles + second;
+				if (seen[key] == position)
+					continue;
+				seen[key] = static_cast<uint32_t>(position);
+
+				if (pass == 0)
+					++starts[key + 1];
+				else
+					lists[next[key]++] = static_cast<uint32_t>(position);
+			}
+		}
+
+		if (pass == 0) {
+			std::partial_sum(starts.begin(), starts.end(), starts.begin());
+			lists.resize(starts.back());
+		}
+	}
+
+	reversed = Table<uint32_t>(std::move(endings));
+	offsets = Table<uint32_t>(std::move(starts));
+	postings = Table<uint32_t>(std::move(lists));
+}
+
+/**
+ * Estimates the number of candidates a query would produce
+ *
+ * @param dictionary is the word list the index was built from
+ * @param query contains the filters
+ * @return size of the smallest candidate list, or the size of the
+ *         dictionary if no filter can use the index
+ */
+size_t SubstringIndex::estimate(_In_ Dictionary const& dictionary,
+	_In_ Query const& query) const {
+	size_t smallest = dictionary.size();
+	if (!query.endsWith.empty())
+		smallest = std::min(smallest, suffix(dictionary, query.endsWith).size());
+
+	std::string_view contains = query.contains;
+	for (size_t i = 1; i < contains.length(); ++i) {
+		int first = Alphabet::tileOf(contains[i - 1]);
+		int second = Alphabet::tileOf(contains[i]);
+		if (first >= 0 && second >= 0)
+			smallest = std::min(smallest, pair(first, second).size());
+	}
+
+	return smallest;
+}
+
+/**
+ * Finds the words that may pass the ends with and contains filters
+ *
+ * Only the first few letter pairs of a long contains filter are used to
+ * narrow the list, which keeps them on the stack. The candidates are checked
+ * against the whole filter afterwards anyway.
+ *
+ * @param dictionary is the word list the index was built from
+ * @param query contains the filters
+ * @param candidates receives the positions of the candidate words in
+ *        ascending order
+ */
+void SubstringIndex::find(_In_ Dictionary const& dictionary,
+	_In_ Query const& query, _Inout_ std::vector<uint32_t>& candidates)
+	const {
+	constexpr size_t MostPairs = 16;
+
+	Range pairs[MostPairs] = {};
+	size_t count = 0;
+	std::string_view contains = query.contains;
+	for (size_t i = 1; i < contains.length() && count < MostPairs; ++i) {
+		int first = Alphabet::tileOf(contains[i - 1]);
+		int second = Alphabet::tileOf(contains[i]);
+		if (first >= 0 && second >= 0)
+			pairs[count++] = pair(first, second);
+	}
+
+	std::sort(pairs, pairs + count, [](_In_ Range const& a,
+		_In_ Range const& b) {
+			return a.size() < b.size();
+		});
+	count = static_cast<size_t>(std::unique(pairs, pairs + count, [](
+		_In_ Range const& a, _In_ Range const& b) {
+			return a.begin == b.begin;
+		}) - pairs);
+
+	size_t start = candidates.size();
+	Range ending = { nullptr, nullptr };
+	if (!query.endsWith.empty())
+		ending = suffix(dictionary, query.endsWith);
+
+	size_t used = 0;
+	if (!query.endsWith.empty()
+		&& (!count || ending.size() <= pairs[0].size())) {
+		candidates.insert(candidates.end(), ending.begin, ending.end);
+		std::sort(candidates.begin() + start, candidates.end());
+	} else if (count) {
+		candidates.insert(candidates.end(), pairs[0].begin, pairs[0].end);
+		used = 1;
+	} else {
+		candidates.resize(start + dictionary.size());
+		std::iota(candidates.begin() + start, candidates.end(), 0);
+		return;
+	}
+
+	for (size_t i = used; i < count; ++i) {
+		Range const& range = pairs[i];
+		candidates.erase(std::remove_if(candidates.begin() + start,
+			candidates.end(), [&range](_In_ uint32_t position) {
+				return !std::binary_search(range.begin, range.end, position);
+			}), candidates.end());
+	}
+}
+
+/**
+ * Finds the words that end with a suffix
+ *
+ * @param dictionary is the word list the index was built from
+ * @param ending is the suffix to look up
+ * @return range of positions in the suffix list, in reversed order
+ */
+SubstringIndex::Range SubstringIndex::suffix(
+	_In_ Dictionary const& dictionary, _In_ std::string_view ending) const {
+	auto first = std::lower_bound(reversed.begin(), reversed.end(), ending,
+		[&dictionary](_In_ uint32_t position, _In_ std::string_view ending) {
+			return compareEnding(dictionary[position], ending) < 0;
+		});
+	auto last = std::upper_bound(first, reversed.end(), ending,
+		[&dictionary](_In_ std::string_view ending, _In_ uint32_t position) {
+			return compareEnding(dictionary[position], ending) > 0;
+		});
+
+	return { reversed.data() + (first - reversed.begin()),
+		reversed.data() + (last - reversed.begin()) };
+}
+
+/**
+ * Finds the words that contain a pair of adjacent letters
+ *
+ * @param first is the position of the first tile in the alphabet
+ * @param second is the position of the second tile in the alphabet
+ * @return range of positions in ascending order
+ */
+SubstringIndex::Range SubstringIndex::pair(_In_ int first,
+	_In_ int second) const {
+	size_t key = first * Alphabet::MaxTiles + second;
+	return { postings.data() + offsets[key],
+		postings.data() + offsets[key + 1] };
+}
+
+/**
+ * Checks that the suffix list and the postings only hold words of the
+ * dictionary and that the posting lists follow one another, for an index
+ * viewed from a lexicon image
+ *
+ * @param words is the number of words in the dictionary
+ * @return true if the index can be searched safely
+ */
+bool SubstringIndex::intact(_In_ size_t words) const {
+	for (uint32_t position : reversed) {
+		if (position >= words)
+			return false;
+	}
+
+	for (uint32_t position : postings) {
+		if (position >= words)
+			return false;
+	}
+
+	for (size_t i = 1; i < offsets.size(); ++i) {
+		if (offsets[i] < offsets[i - 1])
+			return false;
+	}
+
+	return !offsets.empty() && offsets.back() == postings.size();
+}
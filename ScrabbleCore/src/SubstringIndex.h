@@ -0,0 +1,88 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Suffix and substring index for the ends with and contains filters
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <sal.h>
+
+#include "Dictionary.h"
+#include "Query.h"
+#include "Table.h"
+
+/**
+ * Finds the words that end with or contain a string without a full scan
+ *
+ * Ends with is answered by a list of every word sorted by its reversed
+ * spelling, so the words sharing a suffix form one contiguous range. Contains
+ * is answered by a posting list of the words holding each pair of adjacent
+ * letters. Both are case-insensitive and only narrow the search, so every
+ * candidate still has to be checked against the filters themselves.
+ */
+class SubstringIndex {
+public:
+	SubstringIndex() = default;
+
+	/**
+	 * Builds the suffix list and letter pair postings for a dictionary
+	 *
+	 * @param dictionary is the word list to index
+	 */
+	explicit SubstringIndex(_In_ Dictionary const& dictionary);
+
+	/**
+	 * Estimates the number of candidates a query would produce
+	 *
+	 * @param dictionary is the word list the index was built from
+	 * @param query contains the filters
+	 * @return size of the smallest candidate list, or the size of the
+	 *         dictionary if no filter can use the index
+	 */
+	size_t estimate(_In_ Dictionary const& dictionary, _In_ Query const& query)
+		const;
+
+	/**
+	 * Finds the words that may pass the ends with and contains filters
+	 *
+	 * The smallest candidate list is intersected with the posting list of
+	 * every other letter pair in the contains filter.
+	 *
+	 * @param dictionary is the word list the index was built from
+	 * @param query contains the filters
+	 * @param candidates receives the positions of the candidate words in
+	 *        ascending order
+	 */
+	void find(_In_ Dictionary const& dictionary, _In_ Query const& query,
+		_Inout_ std::vector<uint32_t>& candidates) const;
+
+private:
+	/**
+	 * Contiguous run of word positions
+	 */
+	struct Range {
+		uint32_t const* begin;
+		uint32_t const* end;
+
+		size_t size() const {
+			return static_cast<size_t>(end - begin);
+		}
+	};
+
+	friend class LexiconImage;
+
+	Range suffix(_In_ Dictionary const& dictionary,
+		_In_ std::string_view ending) const;
+	Range pair(_In_ int first, _In_ int second) const;
+	bool intact(_In_ size_t words) const;
+
+	Table<uint32_t> reversed;
+	Table<uint32_t> offsets;
+	Table<uint32_t> postings;
+};
@@ -0,0 +1,116 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Read-only array that either owns its elements or views borrowed memory
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <sal.h>
+
+/**
+ * Immutable array used as the storage of the dictionary indexes
+ *
+ * A table built at run time owns a vector, while a table opened from a
+ * compiled lexicon image points straight into the image, so the same index
+ * code runs over either without the image being copied or parsed. A viewing
+ * table does not keep its memory alive by itself; whoever creates it must
+ * hold on to the storage.
+ */
+template <typename T>
+class Table {
+public:
+	Table() = default;
+
+	/**
+	 * Takes ownership of a vector of elements
+	 *
+	 * @param values are the elements of the table
+	 */
+	explicit Table(_In_ std::vector<T> values) : owned(std::move(values)),
+		items(owned.data()), count(owned.size()) {
+	}
+
+	/**
+	 * Views elements stored elsewhere
+	 *
+	 * @param data is the first element
+	 * @param size is the number of elements
+	 */
+	Table(_In_reads_(size) T const* data, _In_ size_t size) : items(data),
+		count(size) {
+	}
+
+	Table(Table const& other) : owned(other.owned),
+		items(owned.empty() ? other.items : owned.data()),
+		count(other.count) {
+	}
+
+	Table(Table&& other) noexcept : owned(std::move(other.owned)),
+		items(owned.empty() ? other.items : owned.data()),
+		count(other.count) {
+		other.items = nullptr;
+		other.count = 0;
+	}
+
+	Table& operator=(Table other) noexcept {
+		owned.swap(other.owned);
+		items = owned.empty() ? other.items : owned.data();
+		count = other.count;
+		return *this;
+	}
+
+	/**
+	 * @return first element of the table
+	 */
+	T const* data() const {
+		return items;
+	}
+
+	/**
+	 * @return number of elements in the table
+	 */
+	size_t size() const {
+		return count;
+	}
+
+	/**
+	 * @return true if the table has no elements
+	 */
+	bool empty() const {
+		return count == 0;
+	}
+
+	T const* begin() const {
+		return items;
+	}
+
+	T const* end() const {
+		return items + count;
+	}
+
+	/**
+	 * @param index is the position of the element
+	 * @return element at the position
+	 */
+	T const& operator[](_In_ size_t index) const {
+		return items[index];
+	}
+
+	/**
+	 * @return last element of the table
+	 */
+	T const& back() const {
+		return items[count - 1];
+	}
+
+private:
+	std::vector<T> owned;
+	T const* items = nullptr;
+	size_t count = 0;
+};
@@ -0,0 +1,131 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Fixed set of worker threads for splitting work across cores
+ */
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+/**
+ * Starts the worker threads
+ *
+ * @param threads is the number of threads that work on each batch,
+ *        including the calling thread
+ */
+ThreadPool::ThreadPool(_In_ size_t threads) {
+	for (size_t i = 1; i < threads; ++i)
+		workers.emplace_back(&ThreadPool::work, this);
+}
+
+/**
+ * Stops and joins the worker threads
+ */
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+
+	wake.notify_all();
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+/**
+ * @return pool shared by the whole program, with one thread per core
+ */
+ThreadPool& ThreadPool::shared() {
+	static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u));
+	return pool;
+}
+
+/**
+ * Runs a batch of tasks and waits for all of them to finish
+ *
+ * Batches from different threads are run one after another. The call only
+ * returns once every worker has also stopped looking at the batch, so the
+ * task can safely go out of scope afterwards.
+ *
+ * @param tasks is the number of tasks in the batch
+ * @param task is called once with each task number from zero to one less
+ *        than tasks, in no particular order
+ */
+void ThreadPool::dispatch(_In_ size_t tasks, _In_ Batch task) {
+	if (!tasks)
+		return;
+
+	if (tasks == 1 || workers.empty()) {
+		for (size_t i = 0; i < tasks; ++i)
+			task.call(task.context, i);
+		return;
+	}
+
+	std::lock_guard<std::mutex> serial(batch);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		current = task;
+		next = 0;
+		total = tasks;
+		remaining = tasks;
+		++generation;
+	}
+
+	wake.notify_all();
+	execute(task);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [this] {
+		return remaining == 0 && active == 0;
+	});
+	current = {};
+}
+
+/**
+ * Waits for batches and works on them until the pool is destroyed
+ */
+void ThreadPool::work() {
+	uint64_t seen = 0;
+	while (true) {
+		Batch task = {};
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this, seen] {
+				return stopping || (current.call && generation != seen);
+			});
+			if (stopping)
+				return;
+
+			seen = generation;
+			task = current;
+			++active;
+		}
+
+		execute(task);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (--active == 0 && remaining == 0)
+			done.notify_all();
+	}
+}
+
+/**
+ * Claims and runs tasks from the current batch until none are left
+ *
+ * @param task is the function of the current batch
+ */
+void ThreadPool::execute(_In_ Batch task) {
+	while (true) {
+		size_t number = next.fetch_add(1);
+		if (number >= total)
+			return;
+
+		task.call(task.context, number);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (--remaining == 0 && active == 0)
+			done.notify_all();
+	}
+}
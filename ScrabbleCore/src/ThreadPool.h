@@ -0,0 +1,95 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Fixed set of worker threads for splitting work across cores
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <sal.h>
+
+/**
+ * Runs numbered tasks in parallel on a set of persistent threads
+ *
+ * Only one batch of tasks runs at a time. The calling thread works on the
+ * batch alongside the pool and does not return until every task is done.
+ */
+class ThreadPool {
+public:
+	/**
+	 * Starts the worker threads
+	 *
+	 * @param threads is the number of threads that work on each batch,
+	 *        including the calling thread
+	 */
+	explicit ThreadPool(_In_ size_t threads);
+
+	ThreadPool(ThreadPool const&) = delete;
+	ThreadPool& operator=(ThreadPool const&) = delete;
+	~ThreadPool();
+
+	/**
+	 * @return pool shared by the whole program, with one thread per core
+	 */
+	static ThreadPool& shared();
+
+	/**
+	 * @return number of threads that work on each batch
+	 */
+	size_t size() const {
+		return workers.size() + 1;
+	}
+
+	/**
+	 * Runs a batch of tasks and waits for all of them to finish
+	 *
+	 * The task is only referred to, never copied, so running a batch does
+	 * not allocate however much the task captures.
+	 *
+	 * @param tasks is the number of tasks in the batch
+	 * @param task is called once with each task number from zero to one
+	 *        less than tasks, in no particular order
+	 */
+	template<typename Task>
+	void run(_In_ size_t tasks, _In_ Task const& task) {
+		dispatch(tasks, { &task, [](_In_ void const* context,
+			_In_ size_t number) {
+				(*static_cast<Task const*>(context))(number);
+			} });
+	}
+
+private:
+	/**
+	 * Reference to the function of a batch
+	 */
+	struct Batch {
+		void const* context;
+		void (*call)(void const*, size_t);
+	};
+
+	void dispatch(_In_ size_t tasks, _In_ Batch task);
+	void work();
+	void execute(_In_ Batch task);
+
+	std::vector<std::thread> workers;
+	std::mutex batch;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	Batch current = {};
+	std::atomic<size_t> next = 0;
+	size_t total = 0;
+	size_t remaining = 0;
+	size_t active = 0;
+	uint64_t generation = 0;
+	bool stopping = false;
+};
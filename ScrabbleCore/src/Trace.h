@@ -0,0 +1,236 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Timers and counters recording where the time of a query goes
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include <sal.h>
+
+#include "Query.h"
+
+/**
+ * Defining SCRABBLE_TRACE as 0 compiles tracing out. Profiles then record
+ * nothing, timers never read the clock and the solver drops every branch
+ * that only feeds them.
+ */
+#ifndef SCRABBLE_TRACE
+#define SCRABBLE_TRACE 1
+#endif
+
+/**
+ * True if timers and counters are compiled in
+ */
+constexpr bool Tracing = SCRABBLE_TRACE != 0;
+
+/**
+ * Part of loading or solving that is timed on its own
+ *
+ * Index covers indexes built after a lexicon is loaded, summed over the
+ * threads building them. Search covers the whole engine. Only the scan,
+ * substring and bitset engines break it down further into the rack check
+ * and the string filters, and those are summed over every thread, so
+ * together they can add up to more than the search itself.
+ */
+enum class Stage : uint8_t {
+	Load, Index, Search, RackCheck, Filter, Sort, Format, Render
+};
+
+/**
+ * Number of stages
+ */
+constexpr size_t StageCount = 8;
+
+/**
+ * Names of the stages, in order, as used in structured output
+ */
+constexpr char const* StageNames[StageCount] = {
+	"load", "index", "search", "rackCheck", "filter", "sort", "format",
+	"render"
+};
+
+/**
+ * Event that is counted while solving
+ *
+ * Scanned counts the words whose rack check was run, and each rejection
+ * counter the words turned away by that check or filter. A word failing
+ * several filters is only counted against the first one.
+ */
+enum class Counter : uint8_t {
+	Scanned, RejectedByRack, RejectedByStartsWith, RejectedByEndsWith,
+	RejectedByContains, RejectedByPattern, Matches
+};
+
+/**
+ * Number of counters
+ */
+constexpr size_t CounterCount = 7;
+
+/**
+ * Names of the counters, in order, as used in structured output
+ */
+constexpr char const* CounterNames[CounterCount] = {
+	"scanned", "rejectedByRack", "rejectedByStartsWith",
+	"rejectedByEndsWith", "rejectedByContains", "rejectedByPattern",
+	"matches"
+};
+
+/**
+ * Names of the engines, in order, as used in structured output
+ */
+constexpr char const* EngineNames[] = {
+	"automatic", "scan", "signature", "dawg", "substring", "gaddag",
+	"bitset"
+};
+
+/**
+ * Time spent in each stage and total of each counter for one query
+ *
+ * A profile is plain data, so it can be copied around with a result and
+ * kept in an arena. It is not synchronized, so threads working on the same
+ * query each fill their own and merge them afterwards.
+ */
+class Profile {
+public:
+	/**
+	 * Adds time to a stage
+	 *
+	 * @param stage is the stage that ran
+	 * @param elapsed is the time it took
+	 */
+	void add(_In_ Stage stage, _In_ std::chrono::nanoseconds elapsed) {
+		if constexpr (Tracing)
+			times[static_cast<size_t>(stage)] += elapsed.count();
+	}
+
+	/**
+	 * Adds to a counter
+	 *
+	 * @param counter is the counter to increase
+	 * @param amount is the amount to add
+	 */
+	void count(_In_ Counter counter, _In_ uint64_t amount = 1) {
+		if constexpr (Tracing)
+			counters[static_cast<size_t>(counter)] += amount;
+	}
+
+	/**
+	 * Counts a word against the first filter of a query that it fails
+	 *
+	 * @param query contains the filters
+	 * @param word is the word that was turned away
+	 */
+	void reject(_In_ Query const& query, _In_ std::string_view word) {
+		if constexpr (Tracing) {
+			if (word.substr(0, query.startsWith.length()) != query.startsWith)
+				count(Counter::RejectedByStartsWith);
+			else if (word.find(query.contains) == std::string_view::npos)
+				count(Counter::RejectedByContains);
+			else if (word.length() < query.endsWith.length()
+				|| word.substr(word.length() - query.endsWith.length())
+				!= query.endsWith)
+				count(Counter::RejectedByEndsWith);
+			else
+				count(Counter::RejectedByPattern);
+		}
+	}
+
+	/**
+	 * Records the engine that solved the query
+	 *
+	 * @param engine is the engine that was used
+	 */
+	void use(_In_ Engine engine) {
+		if constexpr (Tracing)
+			used = engine;
+	}
+
+	/**
+	 * Adds every time and counter of another profile to this one
+	 *
+	 * @param other is the profile to add
+	 */
+	void merge(_In_ Profile const& other) {
+		if constexpr (Tracing) {
+			for (size_t i = 0; i < StageCount; ++i)
+				times[i] += other.times[i];
+			for (size_t i = 0; i < CounterCount; ++i)
+				counters[i] += other.counters[i];
+		}
+	}
+
+	/**
+	 * @param stage is the stage to look up
+	 * @return time spent in the stage in milliseconds
+	 */
+	double milliseconds(_In_ Stage stage) const {
+		return static_cast<double>(times[static_cast<size_t>(stage)]) / 1e6;
+	}
+
+	/**
+	 * @param counter is the counter to look up
+	 * @return total of the counter
+	 */
+	uint64_t total(_In_ Counter counter) const {
+		return counters[static_cast<size_t>(counter)];
+	}
+
+	/**
+	 * @return engine that solved the query, or automatic if none did
+	 */
+	Engine engine() const {
+		return used;
+	}
+
+private:
+	std::array<int64_t, StageCount> times = {};
+	std::array<uint64_t, CounterCount> counters = {};
+	Engine used = Engine::Automatic;
+};
+
+/**
+ * Adds the time between its construction and destruction to a stage
+ */
+class ScopedTimer {
+public:
+	/**
+	 * Starts timing
+	 *
+	 * @param profile receives the time, or is nullptr if nothing is being
+	 *        traced
+	 * @param stage is the stage being timed
+	 */
+	ScopedTimer(_Inout_opt_ Profile* profile, _In_ Stage stage) :
+		profile(profile), stage(stage) {
+		if constexpr (Tracing) {
+			if (profile)
+				start = std::chrono::steady_clock::now();
+		}
+	}
+
+	ScopedTimer(ScopedTimer const&) = delete;
+	ScopedTimer& operator=(ScopedTimer const&) = delete;
+
+	/**
+	 * Stops timing and records the time
+	 */
+	~ScopedTimer() {
+		if constexpr (Tracing) {
+			if (profile)
+				profile->add(stage, std::chrono::steady_clock::now() - start);
+		}
+	}
+
+private:
+	Profile* profile;
+	Stage stage;
+	std::chrono::steady_clock::time_point start;
+};
@@ -0,0 +1,64 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Precomputed letter counts and scores for every word in a dictionary
+ */
+
+#include "WordIndex.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+/**
+ * Builds the index for every word in a dictionary
+ *
+ * Letters are counted case-insensitively. Characters that are not codes of
+ * the alphabet's tiles are ignored by the counts and score nothing, so with
+ * the classic alphabet every score matches calculate().
+ *
+ * @param dictionary is the word list to index, in tile codes
+ * @param alphabet holds the tiles the words are spelled with
+ */
+WordIndex::WordIndex(_In_ Dictionary const& dictionary,
+	_In_ Alphabet const& alphabet) {
+	adopt(alphabet);
+	std::vector<uint8_t> records(dictionary.size() * Stride);
+	std::vector<uint16_t> points(dictionary.size());
+	std::vector<uint8_t> letters(dictionary.size());
+	for (size_t index = 0; index < dictionary.size(); ++index) {
+		std::string_view word = dictionary[index];
+		uint8_t* record = records.data() + index * Stride;
+		int score = 0;
+		for (char letter : word) {
+			int tile = Alphabet::tileOf(letter);
+			if (tile < 0 || static_cast<size_t>(tile) >= tileCount)
+				continue;
+
+			score += tileValues[tile];
+			if (record[tile] < UINT8_MAX)
+				++record[tile];
+		}
+
+		points[index] = static_cast<uint16_t>(std::min(score, UINT16_MAX));
+		letters[index] = static_cast<uint8_t>(std::min<size_t>(word.length(),
+			UINT8_MAX));
+	}
+
+	histograms = Table<uint8_t>(std::move(records));
+	scores = Table<uint16_t>(std::move(points));
+	lengths = Table<uint8_t>(std::move(letters));
+}
+
+/**
+ * Takes the tile count and point values of an alphabet
+ *
+ * @param alphabet holds the tiles the words are spelled with
+ */
+void WordIndex::adopt(_In_ Alphabet const& alphabet) {
+	tileValues = {};
+	tileCount = alphabet.size();
+	for (size_t tile = 0; tile < tileCount; ++tile)
+		tileValues[tile] = alphabet.value(tile);
+}
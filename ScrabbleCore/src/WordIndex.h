@@ -0,0 +1,108 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Precomputed letter counts and scores for every word in a dictionary
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <sal.h>
+
+#include "Alphabet.h"
+#include "Dictionary.h"
+#include "Table.h"
+
+/**
+ * Flat per-word index used by the rack matcher
+ *
+ * Stored as a structure of arrays so the rack check only touches the data it
+ * needs. Every word has a fixed-size record of letter counts, with one byte
+ * per tile of its alphabet and padding bytes that are always zero, followed
+ * in separate arrays by its base score and its length. Counts and lengths
+ * saturate at 255. The point value of every tile is kept laid out like a
+ * record as well.
+ */
+class WordIndex {
+public:
+	/**
+	 * Number of bytes in each word's letter count record
+	 */
+	static constexpr size_t Stride = 32;
+
+	static_assert(Stride == Alphabet::MaxTiles,
+		"every tile needs a byte of the record");
+
+	WordIndex() = default;
+
+	/**
+	 * Builds the index for every word in a dictionary
+	 *
+	 * @param dictionary is the word list to index, in tile codes
+	 * @param alphabet holds the tiles the words are spelled with
+	 */
+	explicit WordIndex(_In_ Dictionary const& dictionary,
+		_In_ Alphabet const& alphabet = Alphabet());
+
+	/**
+	 * @return number of indexed words
+	 */
+	size_t size() const {
+		return scores.size();
+	}
+
+	/**
+	 * @param index is the position of the word in the dictionary
+	 * @return letter count record of the word, with A at offset zero
+	 */
+	uint8_t const* counts(_In_ size_t index) const {
+		return histograms.data() + index * Stride;
+	}
+
+	/**
+	 * @param index is the position of the word in the dictionary
+	 * @return point value of the word when no blanks are used
+	 */
+	int score(_In_ size_t index) const {
+		return scores[index];
+	}
+
+	/**
+	 * @param index is the position of the word in the dictionary
+	 * @return number of characters in the word
+	 */
+	int length(_In_ size_t index) const {
+		return lengths[index];
+	}
+
+	/**
+	 * @return number of tiles in the alphabet of the words
+	 */
+	size_t tiles() const {
+		return tileCount;
+	}
+
+	/**
+	 * @return point value of the tile at each offset of a record, which is
+	 *         zero for the padding
+	 */
+	uint8_t const* values() const {
+		return tileValues.data();
+	}
+
+private:
+	friend class LexiconImage;
+
+	void adopt(_In_ Alphabet const& alphabet);
+
+	Table<uint8_t> histograms;
+	Table<uint16_t> scores;
+	Table<uint8_t> lengths;
+	std::array<uint8_t, Stride> tileValues = {};
+	size_t tileCount = 0;
+};
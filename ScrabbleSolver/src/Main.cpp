@@ -5,218 +5,346 @@
  * Scrabble word finder
  */
 
-#include <algorithm>
-#include <sstream>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <windows.h>
+#include <commctrl.h>
 
+#include "Dictionary.h"
+#include "DictionaryLoader.h"
+#include "Lexicon.h"
+#include "LexiconLibrary.h"
 #include "Menus.h"
 #include "Resources.h"
+#include "SolveWorker.h"
+#include "Trace.h"
 
 /**
- * Sorting method used when outputting possible words from the dictionary
+ * Message posted back to the main window when a solve finishes
+ *
+ * The LPARAM holds a SolveResult that the window takes ownership of.
  */
-enum class SortingMethod : uint8_t {
-	None, Points, Length
-};
-
- /**
-  * Loads the dictionary resource file
-  *
-  * Handles locating and reading the dictionary resource file. The data is
-  * loaded into a vector of strings, each element contains a single word
-  * from the dictionary.
-  *
-  * @param instance is the handle to the program when loaded in memory
-  * @return vector containing resource contents
-  */
-std::vector<std::string> loadDictionary(_In_ HINSTANCE instance) {
-	std::vector<std::string> dictionary;
-
-	HRSRC resInfo = FindResourceW(instance, MAKEINTRESOURCEW(ID_DICTIONARY),
-		L"TXT");
-	if (!resInfo)
-		return {};
-
-	HGLOBAL resData = LoadResource(instance, resInfo);
-	if (!resData)
-		return {};
-
-	LPVOID res = LockResource(resData);
-	if (!res)
-		return {};
+constexpr unsigned int WM_SOLVED = WM_APP + 1;
 
-	DWORD size = SizeofResource(instance, resInfo);
+/**
+ * Message posted back to the main window when a lexicon finishes loading
+ *
+ * The WPARAM holds the identifier of the lexicon in the library.
+ */
+constexpr unsigned int WM_LOADED = WM_APP + 2;
 
-	std::string data;
-	data.assign(static_cast<char*>(res), size);
-	std::stringstream stream(data);
+/**
+ * Creation parameters of the main window
+ */
+struct Startup {
+	wchar_t const* const* paths;
+	int count;
+};
 
-	std::string word;
-	while (std::getline(stream, word)) {
-		word.pop_back();
-		dictionary.push_back(word);
+/**
+ * Copies text into a list view item's buffer
+ *
+ * ASCII text is widened as it is copied, and only text with other
+ * characters goes through a conversion from UTF-8.
+ *
+ * @param item is the list view item whose buffer receives the text
+ * @param text is the text to copy, in UTF-8, which is truncated if it does
+ *        not fit
+ */
+void setItemText(_Inout_ LVITEMW& item, _In_ std::string_view text) {
+	bool ascii = true;
+	for (char character : text)
+		ascii = ascii && static_cast<unsigned char>(character) < 0x80;
+
+	std::wstring wide;
+	if (!ascii) {
+		int size = MultiByteToWideChar(CP_UTF8, 0, text.data(),
+			static_cast<int>(text.length()), nullptr, 0);
+		wide.resize(static_cast<size_t>(size));
+		MultiByteToWideChar(CP_UTF8, 0, text.data(),
+			static_cast<int>(text.length()), wide.data(), size);
 	}
 
-	return dictionary;
+	size_t length = ascii ? text.length() : wide.length();
+	if (length >= static_cast<size_t>(item.cchTextMax))
+		length = item.cchTextMax - 1;
+
+	for (size_t i = 0; i < length; ++i)
+		item.pszText[i] = ascii ? static_cast<wchar_t>(text[i]) : wide[i];
+	item.pszText[length] = L'\0';
 }
 
 /**
- * Converts a letter into its corresponding point value
+ * Reads the text of a control
  *
- * @param letter that will be converted into a point value
- * @return point value of the given letter
+ * @param control is a handle to the control
+ * @return text of the control, in UTF-8
  */
-int convert(_In_ char const letter) {
-	static int points[26] = { 1, 3, 3, 2, 1, 4, 2, 4, 1, 8, 5, 1, 3, 1, 1, 3,
-		10, 1, 1, 1, 1, 4, 4, 8, 4, 10 };
-	if (letter >= 'A' && letter <= 'Z')
-		return points[static_cast<int>(letter - 'A')];
-	else if (letter >= 'a' && letter <= 'z')
-		return points[static_cast<int>(letter - 'a')];
-	return 0;
+std::string readText(_In_ HWND control) {
+	int length = GetWindowTextLengthW(control);
+	if (length <= 0)
+		return {};
+
+	std::wstring wide(static_cast<size_t>(length) + 1, L'\0');
+	length = GetWindowTextW(control, wide.data(), length + 1);
+	int size = WideCharToMultiByte(CP_UTF8, 0, wide.data(), length, nullptr,
+		0, nullptr, nullptr);
+	std::string text(static_cast<size_t>(size), '\0');
+	WideCharToMultiByte(CP_UTF8, 0, wide.data(), length, text.data(), size,
+		nullptr, nullptr);
+	return text;
 }
 
 /**
- * Calculates a word into its total point value
+ * Shows a notice in the first cell of the results list
  *
- * @param word is a string containing the word to be calculated
- * @return point total of the given word
+ * @param item is the cell being asked for
+ * @param notice is the text shown in the first cell
  */
-int calculate(_In_ std::string word) {
-	int points = 0;
-	for (char letter : word)
-		points += convert(letter);
+void announce(_Inout_ LVITEMW& item, _In_ std::string_view notice) {
+	if (!(item.mask & LVIF_TEXT) || !item.pszText || item.cchTextMax <= 0)
+		return;
 
-	return points;
+	item.pszText[0] = L'\0';
+	if (item.iItem == 0 && item.iSubItem == 0)
+		setItemText(item, notice);
 }
 
 /**
- * Finds words that can be made from a list of letters
- * 
- * Takes in a list of letters and a dictionary. Each word in the dictionary is
- * checked to see if it can be made using the given letters. Blank letters are
- * represented using a question mark. After the entire dictionary has been
- * iterated over, the words that can be made are sorted by point value.
- * 
- * @param dictionary is the word list that will be iterated over
- * @param input is the letters to be used when solving for words
- * @param startsWith is the letters used to match at the beginnning of words
- * @param method is the sorting method used for the word list
- * @return string containing a list of words that can be made
+ * Fills in one cell of the results list
+ *
+ * The results list is virtual, so it asks for the text of each cell only
+ * when the cell is painted. Only rows that are visible are ever formatted,
+ * straight from the dictionary, with words mapped back from the tiles of
+ * the lexicon's alphabet unless it is classic. The first column holds the
+ * word and the second its points.
+ *
+ * @param item is the cell being asked for
+ * @param shown is the result being displayed, or nullptr if there is none
+ * @param lexicon is the dictionary the result was found in
  */
-std::string solve(_In_ std::vector<std::string> dictionary, _In_ char* input,
-	_In_opt_ char* startsWith, _In_opt_ char* endsWith, _In_opt_ char* contains,
-	_In_ SortingMethod method) {
-	char letters[27] = {};
-	for (size_t i = 0; i < strlen(input); ++i) {
-		if (input[i] >= 'A' && input[i] <= 'Z')
-			++letters[input[i] - 'A'];
-		else if (input[i] >= 'a' && input[i] <= 'z')
-			++letters[input[i] - 'a'];
-		else if (input[i] == '?')
-			++letters[26];
+void describe(_Inout_ LVITEMW& item, _In_opt_ SolveResult const* shown,
+	_In_ Lexicon const& lexicon) {
+	if (!(item.mask & LVIF_TEXT) || !item.pszText || item.cchTextMax <= 0)
+		return;
+
+	item.pszText[0] = L'\0';
+	if (!shown || item.iItem < 0)
+		return;
+
+	size_t row = static_cast<size_t>(item.iItem);
+	if (shown->matches.empty()) {
+		announce(item, "No results");
+		return;
 	}
 
-	std::vector<std::pair<std::string, int>> words;
-	for (std::string word : dictionary) {
-		if (word.rfind(startsWith, 0) == std::string::npos)
-			continue;
-		if (word.find(endsWith, word.length() - strlen(endsWith))
-			== std::string::npos)
-			continue;
-		if (word.find(contains) == std::string::npos)
-			continue;
-
-		char frequency[26] = {};
-		for (size_t i = 0; i < word.length(); ++i) {
-			if (word.at(i) >= 'A' && word.at(i) <= 'Z')
-				++frequency[word.at(i) - 'A'];
-			else if (word.at(i) >= 'a' && word.at(i) <= 'z')
-				++frequency[word.at(i) - 'a'];
-		}
-
-		bool valid = true;
-		int blanks = letters[26];
-		int points = calculate(word);
-		for (int i = 0; i < 26; ++i) {
-			if (frequency[i] > letters[i]) {
-				if (blanks >= frequency[i] - letters[i]) {
-					blanks -= frequency[i] - letters[i];
-					points -= convert(static_cast<char>(i + 'A')) *
-						(frequency[i] - letters[i]);
-				} else {
-					valid = false;
-					break;
-				}
-			}
-		}
-
-		if (valid) {
-			words.push_back(make_pair(word, points));
-		}
+	if (row >= shown->matches.size())
+		return;
+
+	Match const& match = shown->matches[row];
+	if (item.iSubItem == 0) {
+		std::string_view word = lexicon.dictionary()[match.index];
+		if (lexicon.alphabet().classic())
+			setItemText(item, word);
+		else
+			setItemText(item, lexicon.alphabet().decode(word));
+	} else {
+		char points[16] = {};
+		char* end = std::to_chars(points, points + sizeof(points),
+			match.points).ptr;
+		setItemText(item, std::string_view(points, end - points));
 	}
+}
 
-	switch (method) {
-		case SortingMethod::Points:
-			std::sort(words.begin(), words.end(), [](
-				_In_ std::pair<std::string, int> a,
-				_In_ std::pair<std::string, int> b) {
-					if (a.second == b.second) {
-						if (a.first.length() == b.first.length()) {
-							for (size_t i = 0; i < a.first.length(); ++i) {
-								if (a.first.at(i) == b.first.at(i))
-									continue;
-								return a.first.at(i) < b.first.at(i);
-							}
-						}
-
-						return a.first.length() < b.first.length();
-					}
+/**
+ * Shows the progress of loading a lexicon in the first part of the status
+ * bar
+ *
+ * While indexes are still being built, queries are answered by the engines
+ * that are ready, so the number left shows when the fastest engine for
+ * every query is available.
+ *
+ * @param window is a handle to the main window
+ * @param lexicon is the lexicon being searched, or nullptr if it is not
+ *        loaded yet
+ * @param loading holds the time spent loading
+ */
+void reportLoad(_In_ HWND window, _In_opt_ Lexicon const* lexicon,
+	_In_ Profile const& loading) {
+	char text[64] = {};
+	if (lexicon && lexicon->missing())
+		snprintf(text, sizeof(text), "Indexing, %zu left",
+			lexicon->missing());
+	else if (lexicon && Tracing)
+		snprintf(text, sizeof(text), "Loaded in %.0f ms",
+			loading.milliseconds(Stage::Load));
+	else if (lexicon)
+		snprintf(text, sizeof(text), "Loaded");
+
+	SendDlgItemMessageA(window, IDM_STATUS, SB_SETTEXTA, 0,
+		reinterpret_cast<LPARAM>(text));
+}
 
-					return a.second < b.second;
-				});
-			break;
-		case SortingMethod::Length:
-			std::sort(words.begin(), words.end(), [](
-				_In_ std::pair<std::string, int> a,
-				_In_ std::pair<std::string, int> b) {
-					if (a.first.length() == b.first.length()) {
-						for (size_t i = 0; i < a.first.length(); ++i) {
-							if (a.first.at(i) == b.first.at(i))
-								continue;
-							return a.first.at(i) < b.first.at(i);
-						}
-					}
+/**
+ * Shows where the time of a query went in the status bar
+ *
+ * The second part holds the engine used and the timings of each stage and
+ * the third the counters, or both are cleared if there is no result. Results
+ * from the cache were not solved, so only the time to show them is given.
+ *
+ * @param window is a handle to the main window
+ * @param result is the result being displayed, or nullptr if there is none
+ */
+void reportQuery(_In_ HWND window, _In_opt_ SolveResult const* result) {
+	char timings[128] = {};
+	char counters[128] = {};
+	if (result && Tracing) {
+		Profile const& profile = result->profile;
+		if (result->cached)
+			snprintf(timings, sizeof(timings), "Cached, render %.2f ms",
+				profile.milliseconds(Stage::Render));
+		else
+			snprintf(timings, sizeof(timings), "%s %.2f (rack %.2f, filter "
+				"%.2f) sort %.2f render %.2f ms",
+				EngineNames[static_cast<size_t>(profile.engine())],
+				profile.milliseconds(Stage::Search),
+				profile.milliseconds(Stage::RackCheck),
+				profile.milliseconds(Stage::Filter),
+				profile.milliseconds(Stage::Sort),
+				profile.milliseconds(Stage::Render));
+
+		unsigned long long filtered =
+			profile.total(Counter::RejectedByStartsWith)
+			+ profile.total(Counter::RejectedByEndsWith)
+			+ profile.total(Counter::RejectedByContains)
+			+ profile.total(Counter::RejectedByPattern);
+		snprintf(counters, sizeof(counters),
+			"%zu found, %llu scanned, %llu by rack, %llu by filter",
+			result->matches.size(), static_cast<unsigned long long>(
+				profile.total(Counter::Scanned)),
+			static_cast<unsigned long long>(
+				profile.total(Counter::RejectedByRack)), filtered);
+	} else if (result)
+		snprintf(counters, sizeof(counters), "%zu found",
+			result->matches.size());
+
+	SendDlgItemMessageA(window, IDM_STATUS, SB_SETTEXTA, 1,
+		reinterpret_cast<LPARAM>(timings));
+	SendDlgItemMessageA(window, IDM_STATUS, SB_SETTEXTA, 2,
+		reinterpret_cast<LPARAM>(counters));
+}
 
-					return a.first.length() < b.first.length();
-				});
-			break;
+/**
+ * Submits the query currently entered in a window
+ *
+ * Called whenever the letters, filters, pattern or sorting method change,
+ * so results update while the user types. If no letters are entered, the
+ * results are cleared instead.
+ *
+ * @param window is a handle to the main window
+ * @param worker solves the query in the background
+ * @param latest receives the generation of the submitted query, or zero if
+ *        nothing was submitted
+ */
+void search(_In_ HWND window, _Inout_ SolveWorker& worker,
+	_Out_ uint64_t& latest) {
+	HWND letters = GetDlgItem(window, IDM_LETTERS);
+	HWND starts = GetDlgItem(window, IDM_STARTS);
+	HWND ends = GetDlgItem(window, IDM_ENDS);
+	HWND contains = GetDlgItem(window, IDM_CONTAINS);
+	HWND pattern = GetDlgItem(window, IDM_PATTERN);
+
+	SortingMethod method = SortingMethod::None;
+	if (IsDlgButtonChecked(window, IDM_POINTS) == BST_CHECKED)
+		method = SortingMethod::Points;
+	else if (IsDlgButtonChecked(window, IDM_LENGTH) == BST_CHECKED)
+		method = SortingMethod::Length;
+
+	SolveRequest request;
+	request.letters = readText(letters);
+	if (request.letters.empty()) {
+		ListView_SetItemCountEx(GetDlgItem(window, IDM_RESULTS), 0, 0);
+		latest = 0;
+		return;
 	}
 
-	std::string results;
-	if (words.empty())
-		results = "No results";
-	else {
-		for (std::pair<std::string, int> pair : words)
-			results.append(pair.first + " (" + std::to_string(pair.second) +
-				")\r\n");
+	request.startsWith = readText(starts);
+	request.endsWith = readText(ends);
+	request.contains = readText(contains);
+	request.pattern = readText(pattern);
+	request.method = method;
+	latest = worker.submit(std::move(request));
+}
 
-		results.pop_back();
-		results.pop_back();
+/**
+ * Switches the main window to another lexicon
+ *
+ * The worker for the previous lexicon is stopped and its results are
+ * dropped. A lexicon that is still loading is shown as a notice until the
+ * window is told that it is ready, and is then activated again. Otherwise a
+ * new worker is started and the current query is solved against it.
+ *
+ * @param window is a handle to the main window
+ * @param next is the lexicon to switch to, or nullptr if it is not ready
+ * @param loading holds the time spent loading the lexicon to switch to
+ * @param lexicon receives the lexicon that is searched
+ * @param worker receives the worker that searches the lexicon
+ * @param shown is the result being displayed, which is cleared
+ * @param latest receives the generation of the submitted query, or zero if
+ *        nothing was submitted
+ */
+void activate(_In_ HWND window, _In_ std::shared_ptr<Lexicon const> next,
+	_In_ Profile const& loading,
+	_Inout_ std::shared_ptr<Lexicon const>& lexicon,
+	_Inout_ std::unique_ptr<SolveWorker>& worker,
+	_Inout_ std::unique_ptr<SolveResult>& shown, _Out_ uint64_t& latest) {
+	worker.reset();
+	shown.reset();
+	lexicon = std::move(next);
+	latest = 0;
+
+	HWND results = GetDlgItem(window, IDM_RESULTS);
+	reportLoad(window, lexicon.get(), loading);
+	reportQuery(window, nullptr);
+	if (!lexicon) {
+		ListView_SetItemCountEx(results, 1, 0);
+		return;
 	}
 
-	return results;
+	worker = std::make_unique<SolveWorker>(*lexicon, [window](
+		_In_ std::unique_ptr<SolveResult> solved) {
+			if (PostMessageW(window, WM_SOLVED, 0,
+				reinterpret_cast<LPARAM>(solved.get())))
+				solved.release();
+		});
+	ListView_SetItemCountEx(results, 0, 0);
+	search(window, *worker, latest);
 }
 
 /**
  * Processes messages sent to a window
  * 
  * Window procedure for the application's main window. On window creation,
- * three child windows are created and the dictionary resource file is
- * loaded.
+ * the child windows are created and every dictionary passed in through the
+ * creation parameters is registered next to the compiled image in the
+ * resources. Only the selected lexicon is loaded, in the background, and
+ * any other is loaded the first time it is picked from the list, after
+ * which it stays resident. If an external dictionary cannot be loaded, the
+ * built-in one is used instead. Queries are solved by a background worker,
+ * which posts its results back so the window stays responsive, and only the
+ * result of the most recent query is shown. A new query is submitted on
+ * every edit, so the results follow the user's typing. Results are shown in
+ * a virtual list view that formats only the rows on screen, and the status
+ * bar below it shows how long loading and each stage of the last query
+ * took, including painting the results. When the window is destroyed, the
+ * worker is stopped first, and any results it posted that are still
+ * queued are freed.
  *
  * @param window is a handle to the window
  * @param msg contains the message value
@@ -226,14 +354,26 @@ std::string solve(_In_ std::vector<std::string> dictionary, _In_ char* input,
  */
 LRESULT CALLBACK procedure(_In_ HWND window, _In_ unsigned int msg,
 	_In_ WPARAM wParam, _In_ LPARAM lParam) {
-	static std::vector<std::string> dictionary;
+	static std::unique_ptr<LexiconLibrary> library;
+	static std::shared_ptr<Lexicon const> lexicon;
+	static size_t builtIn = 0;
+	static size_t selected = 0;
+	static std::unique_ptr<SolveWorker> worker;
+	static uint64_t latest = 0;
+	static std::unique_ptr<SolveResult> shown;
 	LRESULT result = 0;
 
 	switch (msg) {
 		case WM_CREATE:
 		{
 			HINSTANCE instance = GetModuleHandleW(nullptr);
-			dictionary = loadDictionary(instance);
+			CREATESTRUCTW* create = reinterpret_cast<CREATESTRUCTW*>(lParam);
+			Startup const* startup =
+				static_cast<Startup const*>(create->lpCreateParams);
+			library = std::make_unique<LexiconLibrary>([window](
+				_In_ size_t id) {
+					PostMessageW(window, WM_LOADED, id, 0);
+				});
 
 			RECT rect = {};
 			GetClientRect(window, &rect);
@@ -250,36 +390,158 @@ LRESULT CALLBACK procedure(_In_ HWND window, _In_ unsigned int msg,
 			CreateWindowExW(NULL, L"Edit", nullptr, WS_CHILD | WS_VISIBLE
 				| WS_BORDER | ES_UPPERCASE, 95, 100, 125, 20, window,
 				reinterpret_cast<HMENU>(IDM_CONTAINS), instance, nullptr);
+			CreateWindowExW(NULL, L"Edit", nullptr, WS_CHILD | WS_VISIBLE
+				| WS_BORDER | ES_UPPERCASE | ES_AUTOHSCROLL, 95, 130, 125, 20,
+				window, reinterpret_cast<HMENU>(IDM_PATTERN), instance,
+				nullptr);
 
 			CreateWindowExW(NULL, L"Button", L"Sorting Method", WS_CHILD
-				| WS_VISIBLE | BS_CENTER | BS_GROUPBOX, 10, 130,
+				| WS_VISIBLE | BS_CENTER | BS_GROUPBOX, 10, 160,
 				210, 80, window, reinterpret_cast<HMENU>(IDM_SORTING),
 				instance, nullptr);
 			CreateWindowExW(NULL, L"Button", L"Points", WS_CHILD | WS_VISIBLE
-				| BS_AUTORADIOBUTTON, 20, 150, 100, 20, window,
+				| BS_AUTORADIOBUTTON, 20, 180, 100, 20, window,
 				reinterpret_cast<HMENU>(IDM_POINTS), instance, nullptr);
 			CreateWindowExW(NULL, L"Button", L"Length", WS_CHILD | WS_VISIBLE
-				| BS_AUTORADIOBUTTON, 20, 180, 100, 20, window,
+				| BS_AUTORADIOBUTTON, 20, 210, 100, 20, window,
 				reinterpret_cast<HMENU>(IDM_LENGTH), instance, nullptr);
 
 			CreateWindowExW(NULL, L"Button", L"Solve", WS_CHILD | WS_VISIBLE,
-				25, 220, 80, 20, window, reinterpret_cast<HMENU>(IDM_SOLVE),
+				25, 250, 80, 20, window, reinterpret_cast<HMENU>(IDM_SOLVE),
 				instance, nullptr);
 			CreateWindowExW(NULL, L"Button", L"Clear", WS_CHILD | WS_VISIBLE,
-				125, 220, 80, 20, window, reinterpret_cast<HMENU>(IDM_CLEAR),
+				125, 250, 80, 20, window, reinterpret_cast<HMENU>(IDM_CLEAR),
 				instance, nullptr);
 
-			CreateWindowExW(NULL, L"Edit", nullptr, WS_CHILD | WS_VISIBLE
-				| WS_VSCROLL | ES_READONLY | ES_UPPERCASE | ES_MULTILINE, 230,
-				10, rect.right - 240, rect.bottom - 20, window,
+			HWND lexicons = CreateWindowExW(NULL, L"ComboBox", nullptr,
+				WS_CHILD | WS_VISIBLE | WS_VSCROLL | CBS_DROPDOWNLIST, 95, 280,
+				125, 200, window, reinterpret_cast<HMENU>(IDM_LEXICON),
+				instance, nullptr);
+			builtIn = library->add(L"Built-in", instance, ID_DICTIONARY);
+			SendMessageW(lexicons, CB_ADDSTRING, 0,
+				reinterpret_cast<LPARAM>(L"Built-in"));
+			selected = builtIn;
+			for (int i = 0; startup && i < startup->count; ++i) {
+				std::filesystem::path path = startup->paths[i];
+				std::wstring name = path.stem().wstring();
+				size_t id = library->add(name, path.wstring());
+				if (id == library->size() - 1 && id != builtIn)
+					SendMessageW(lexicons, CB_ADDSTRING, 0,
+						reinterpret_cast<LPARAM>(name.c_str()));
+				if (i == 0)
+					selected = id;
+			}
+
+			SendMessageW(lexicons, CB_SETCURSEL, selected, 0);
+
+			HWND status = CreateWindowExW(NULL, STATUSCLASSNAMEW, nullptr,
+				WS_CHILD | WS_VISIBLE, 0, 0, 0, 0, window,
+				reinterpret_cast<HMENU>(IDM_STATUS), instance, nullptr);
+			int parts[] = { 120, 120 + (rect.right - 120) * 3 / 5, -1 };
+			SendMessageW(status, SB_SETPARTS, 3,
+				reinterpret_cast<LPARAM>(parts));
+
+			RECT bar = {};
+			GetWindowRect(status, &bar);
+			int height = rect.bottom - 20 - (bar.bottom - bar.top);
+
+			int width = rect.right - 240;
+			HWND results = CreateWindowExW(NULL, WC_LISTVIEWW, nullptr,
+				WS_CHILD | WS_VISIBLE | WS_BORDER | LVS_REPORT | LVS_OWNERDATA
+				| LVS_SINGLESEL, 230, 10, width, height, window,
 				reinterpret_cast<HMENU>(IDM_RESULTS), instance, nullptr);
+			ListView_SetExtendedListViewStyle(results, LVS_EX_FULLROWSELECT
+				| LVS_EX_DOUBLEBUFFER);
+
+			int pointsWidth = 60;
+			LVCOLUMNW column = {};
+			column.mask = LVCF_TEXT | LVCF_WIDTH;
+			column.cx = width - pointsWidth - GetSystemMetrics(SM_CXVSCROLL)
+				- 4;
+			column.pszText = const_cast<wchar_t*>(L"Word");
+			ListView_InsertColumn(results, 0, &column);
+
+			column.mask |= LVCF_FMT;
+			column.fmt = LVCFMT_RIGHT;
+			column.cx = pointsWidth;
+			column.pszText = const_cast<wchar_t*>(L"Points");
+			ListView_InsertColumn(results, 1, &column);
 
 			CheckRadioButton(window, IDM_POINTS, IDM_LENGTH, IDM_POINTS);
+			activate(window, library->acquire(selected),
+				library->profile(selected), lexicon, worker, shown, latest);
 			break;
 		}
 		case WM_DESTROY:
+		{
+			worker.reset();
+
+			MSG pending = {};
+			while (PeekMessageW(&pending, window, WM_SOLVED, WM_SOLVED,
+				PM_REMOVE))
+				delete reinterpret_cast<SolveResult*>(pending.lParam);
+
+			shown.reset();
+			lexicon.reset();
+			library.reset();
 			PostQuitMessage(0);
 			break;
+		}
+		case WM_LOADED:
+			if (wParam == selected && !lexicon) {
+				std::shared_ptr<Lexicon const> next =
+					library->acquire(selected);
+				if (!next && selected != builtIn) {
+					selected = builtIn;
+					SendDlgItemMessageW(window, IDM_LEXICON, CB_SETCURSEL,
+						selected, 0);
+					next = library->acquire(selected);
+				}
+
+				activate(window, std::move(next), library->profile(selected),
+					lexicon, worker, shown, latest);
+			} else if (wParam == selected)
+				reportLoad(window, lexicon.get(), library->profile(selected));
+
+			break;
+		case WM_SOLVED:
+		{
+			std::unique_ptr<SolveResult> solved(
+				reinterpret_cast<SolveResult*>(lParam));
+			if (solved->generation == latest) {
+				HWND results = GetDlgItem(window, IDM_RESULTS);
+				size_t rows = solved->matches.empty() ? 1
+					: solved->matches.size();
+				shown = std::move(solved);
+				{
+					ScopedTimer timer(&shown->profile, Stage::Render);
+					ListView_SetItemCountEx(results, static_cast<int>(rows),
+						0);
+					ListView_EnsureVisible(results, 0, FALSE);
+					UpdateWindow(results);
+				}
+
+				reportQuery(window, shown.get());
+			}
+
+			break;
+		}
+		case WM_NOTIFY:
+		{
+			NMHDR* header = reinterpret_cast<NMHDR*>(lParam);
+			if (header->idFrom == IDM_RESULTS
+				&& header->code == LVN_GETDISPINFOW) {
+				LVITEMW& item = reinterpret_cast<NMLVDISPINFOW*>(lParam)->item;
+				if (lexicon)
+					describe(item, shown.get(), *lexicon);
+				else if (library->state(selected) == LexiconState::Failed)
+					announce(item, "Could not load the dictionary");
+				else
+					announce(item, "Loading the dictionary...");
+			} else
+				result = DefWindowProcW(window, msg, wParam, lParam);
+			break;
+		}
 		case WM_PAINT:
 		{
 			PAINTSTRUCT paint = {};
@@ -302,6 +564,14 @@ LRESULT CALLBACK procedure(_In_ HWND window, _In_ unsigned int msg,
 			DrawTextW(context, L"Contains:", -1, &rect, DT_SINGLELINE
 				| DT_VCENTER | DT_RIGHT);
 
+			rect = { 10, 130, 85, 150 };
+			DrawTextW(context, L"Pattern:", -1, &rect, DT_SINGLELINE
+				| DT_VCENTER | DT_RIGHT);
+
+			rect = { 10, 280, 85, 300 };
+			DrawTextW(context, L"Dictionary:", -1, &rect, DT_SINGLELINE
+				| DT_VCENTER | DT_RIGHT);
+
 			EndPaint(window, &paint);
 			ReleaseDC(window, context);
 			break;
@@ -313,52 +583,53 @@ LRESULT CALLBACK procedure(_In_ HWND window, _In_ unsigned int msg,
 			if (HIWORD(wParam) == BN_CLICKED) {
 				switch (LOWORD(wParam)) {
 					case IDM_SOLVE:
-					{
-						HWND letters = GetDlgItem(window, IDM_LETTERS);
-						HWND starts = GetDlgItem(window, IDM_STARTS);
-						HWND ends = GetDlgItem(window, IDM_ENDS);
-						HWND contains = GetDlgItem(window, IDM_CONTAINS);
-						HWND results = GetDlgItem(window, IDM_RESULTS);
-
-						SortingMethod method = SortingMethod::None;
-						if (IsDlgButtonChecked(window, IDM_POINTS)
-							== BST_CHECKED)
-							method = SortingMethod::Points;
-						else if (IsDlgButtonChecked(window, IDM_LENGTH)
-							== BST_CHECKED)
-							method = SortingMethod::Length;
-
-						char input[16] = {};
-						char startsWith[16] = {};
-						char endsWith[16] = {};
-						char containsStr[16] = {};
-						if (GetWindowTextA(letters, input, 16)) {
-							GetWindowTextA(starts, startsWith, 16);
-							GetWindowTextA(ends, endsWith, 16);
-							GetWindowTextA(contains, containsStr, 16);
-							std::string words = solve(dictionary, input,
-								startsWith, endsWith, containsStr, method);
-							SetWindowTextA(results, words.c_str());
-						}
-
+					case IDM_POINTS:
+					case IDM_LENGTH:
+						if (worker)
+							search(window, *worker, latest);
 						break;
-					}
 					case IDM_CLEAR:
 					{
 						HWND letters = GetDlgItem(window, IDM_LETTERS);
 						HWND starts = GetDlgItem(window, IDM_STARTS);
 						HWND ends = GetDlgItem(window, IDM_ENDS);
 						HWND contains = GetDlgItem(window, IDM_CONTAINS);
+						HWND pattern = GetDlgItem(window, IDM_PATTERN);
 						HWND results = GetDlgItem(window, IDM_RESULTS);
 
 						SetWindowTextW(letters, L"");
 						SetWindowTextW(starts, L"");
 						SetWindowTextW(ends, L"");
 						SetWindowTextW(contains, L"");
-						SetWindowTextW(results, L"");
+						SetWindowTextW(pattern, L"");
+						ListView_SetItemCountEx(results, lexicon ? 0 : 1, 0);
+						shown.reset();
+						reportQuery(window, nullptr);
+						latest = 0;
 						break;
 					}
 				}
+			} else if (HIWORD(wParam) == EN_CHANGE) {
+				switch (LOWORD(wParam)) {
+					case IDM_LETTERS:
+					case IDM_STARTS:
+					case IDM_ENDS:
+					case IDM_CONTAINS:
+					case IDM_PATTERN:
+						if (worker)
+							search(window, *worker, latest);
+						break;
+				}
+			} else if (HIWORD(wParam) == CBN_SELCHANGE
+				&& LOWORD(wParam) == IDM_LEXICON) {
+				LRESULT item = SendDlgItemMessageW(window, IDM_LEXICON,
+					CB_GETCURSEL, 0, 0);
+				if (item != CB_ERR && static_cast<size_t>(item) != selected) {
+					selected = static_cast<size_t>(item);
+					activate(window, library->acquire(selected),
+						library->profile(selected), lexicon, worker, shown,
+						latest);
+				}
 			}
 
 			break;
@@ -392,7 +663,9 @@ LRESULT CALLBACK procedure(_In_ HWND window, _In_ unsigned int msg,
  * Program entry-point
  *
  * Standard Windows entry-point for C and C++ programs. Creates the window and
- * loops over window messages until the window closes, then exits.
+ * loops over window messages until the window closes, then exits. Every
+ * command-line argument is the path to an external dictionary file that is
+ * offered next to the built-in resource, and the first one is selected.
  *
  * @param instance is the handle to the program when loaded in memory
  * @param prevInstance is used for backwards compatability with 16-bit Windows
@@ -402,6 +675,11 @@ LRESULT CALLBACK procedure(_In_ HWND window, _In_ unsigned int msg,
  */
 int WINAPI wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prevInstance,
 	_In_ PWSTR cmdLine, _In_ int cmdShow) {
+	INITCOMMONCONTROLSEX controls = {};
+	controls.dwSize = sizeof(INITCOMMONCONTROLSEX);
+	controls.dwICC = ICC_LISTVIEW_CLASSES | ICC_BAR_CLASSES;
+	InitCommonControlsEx(&controls);
+
 	WNDCLASSEXW windowClass = {};
 	windowClass.cbSize = sizeof(WNDCLASSEXW);
 	windowClass.lpfnWndProc = procedure;
@@ -411,10 +689,18 @@ int WINAPI wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prevInstance,
 	windowClass.lpszClassName = L"Scrabble Solver";
 	RegisterClassExW(&windowClass);
 
+	int argc = 0;
+	LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+	Startup startup = {};
+	if (argv && argc > 1)
+		startup = { argv + 1, argc - 1 };
+
 	HWND window = CreateWindowExW(NULL, windowClass.lpszClassName,
 		L"Scrabble Solver", WS_MINIMIZEBOX | WS_SYSMENU, CW_USEDEFAULT,
-		CW_USEDEFAULT, 600, 400, nullptr, nullptr, instance, nullptr);
+		CW_USEDEFAULT, 600, 400, nullptr, nullptr, instance,
+		&startup);
 	ShowWindow(window, cmdShow);
+	LocalFree(argv);
 
 	MSG msg = {};
 	while (GetMessageW(&msg, window, NULL, NULL) > 0) {
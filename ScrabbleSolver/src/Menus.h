@@ -10,3 +10,6 @@ constexpr int IDM_LENGTH = 107;
 constexpr int IDM_SOLVE = 108;
 constexpr int IDM_CLEAR = 109;
 constexpr int IDM_RESULTS = 110;
+constexpr int IDM_LEXICON = 111;
+constexpr int IDM_STATUS = 112;
+constexpr int IDM_PATTERN = 113;
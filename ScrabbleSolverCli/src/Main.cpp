@@ -0,0 +1,954 @@
+/**
+ * @file
+ * @author Isaiah Lateer
+ *
+ * Command-line Scrabble word finder
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cwchar>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <io.h>
+#include <windows.h>
+
+#include "Resources.h"
+#include "ScrabbleCore.h"
+
+/**
+ * Layout used when writing results
+ */
+enum class Format : uint8_t {
+	Tsv, Json
+};
+
+/**
+ * Settings given on the command line
+ */
+struct Options {
+	wchar_t const* dictionary = nullptr;
+	wchar_t const* input = nullptr;
+	wchar_t const* pipe = nullptr;
+	wchar_t const* leaves = nullptr;
+	Format format = Format::Tsv;
+	SortingMethod method = SortingMethod::Points;
+	Engine engine = Engine::Automatic;
+	size_t limit = 0;
+	bool hooks = false;
+	bool moves = false;
+	bool trace = false;
+};
+
+/**
+ * Prints how the program is used
+ */
+void printUsage() {
+	fputs("Usage: ScrabbleSolverCli [options] [file]\n"
+		"       ScrabbleSolverCli [options] --serve <name>\n"
+		"\n"
+		"Reads one query per line from the file, or from standard input if no\n"
+		"file is given. Each line holds the letters, then optionally the\n"
+		"starts with, ends with and contains filters, a pattern, the tiles\n"
+		"already on the board that words must run through and the number of\n"
+		"letters before them, separated by tabs. Blanks are written as\n"
+		"question marks. Tiles on the board cost nothing, and without a\n"
+		"number they may sit anywhere in a word.\n"
+		"\n"
+		"Patterns match whole words. ? is any letter, * any run of letters,\n"
+		"[AEI] or [A-E] one of the letters and [^AEI] any other letter, and\n"
+		"{n}, {m,n} or {m,} repeats what comes before it. A pattern that\n"
+		"cannot be parsed matches nothing.\n"
+		"\n"
+		"An image compiled with another alphabet is queried in UTF-8 with the\n"
+		"spellings of its tiles, and its words are written the same way.\n"
+		"\n"
+		"Options:\n"
+		"  --dictionary <file>  use a word list or compiled image instead of the\n"
+		"                       built-in one\n"
+		"  --format tsv|json    output layout, tsv by default\n"
+		"  --sort points|length|none\n"
+		"                       sorting method, points by default\n"
+		"  --limit <count>      keep only the best matches, best first\n"
+		"  --engine automatic|scan|signature|dawg|substring|gaddag|bitset\n"
+		"                       index used to find words\n"
+		"  --hooks              treat the tiles on the board as a played word\n"
+		"                       and only find the longer words it can be\n"
+		"                       extended into\n"
+		"  --moves              play a game from an empty board, where the\n"
+		"                       first field of every line is a rack whose\n"
+		"                       moves are written, best first, and whose\n"
+		"                       best move is played\n"
+		"  --leaves <file>      rank words by their points plus the value of\n"
+		"                       the tiles they keep, from a table compiled by\n"
+		"                       DictionaryCompiler, and write both values;\n"
+		"                       racks may hold at most seven tiles\n"
+		"  --trace              write the timings and counters of loading and\n"
+		"                       of every query to standard error as JSON\n"
+		"  --serve <name>       keep the dictionary loaded and answer queries\n"
+		"                       from any number of clients on the named pipe\n"
+		"                       of that name, ending the rows of each query\n"
+		"                       with an empty line in tsv\n",
+		stderr);
+}
+
+/**
+ * Reads a count given on the command line
+ *
+ * @param value is the argument holding the count
+ * @param count receives the count
+ * @return false if the argument is not a whole number of digits or does not
+ *         fit in a count
+ */
+bool parseCount(_In_ wchar_t const* value, _Out_ size_t& count) {
+	count = 0;
+	if (*value < L'0' || *value > L'9')
+		return false;
+
+	wchar_t* end = nullptr;
+	errno = 0;
+	unsigned long long parsed = wcstoull(value, &end, 10);
+	if (*end || errno == ERANGE || parsed > SIZE_MAX)
+		return false;
+
+	count = static_cast<size_t>(parsed);
+	return true;
+}
+
+/**
+ * Reads the command-line arguments
+ *
+ * @param argc is the number of arguments
+ * @param argv contains the arguments
+ * @param options receives the settings
+ * @return false if the arguments are not valid
+ */
+bool parseOptions(_In_ int argc, _In_reads_(argc) wchar_t* argv[],
+	_Out_ Options& options) {
+	options = {};
+	for (int i = 1; i < argc; ++i) {
+		std::wstring_view argument = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (argument == L"--dictionary" && hasValue) {
+			options.dictionary = argv[++i];
+		} else if (argument == L"--format" && hasValue) {
+			std::wstring_view value = argv[++i];
+			if (value == L"tsv")
+				options.format = Format::Tsv;
+			else if (value == L"json")
+				options.format = Format::Json;
+			else
+				return false;
+		} else if (argument == L"--sort" && hasValue) {
+			std::wstring_view value = argv[++i];
+			if (value == L"points")
+				options.method = SortingMethod::Points;
+			else if (value == L"length")
+				options.method = SortingMethod::Length;
+			else if (value == L"none")
+				options.method = SortingMethod::None;
+			else
+				return false;
+		} else if (argument == L"--limit" && hasValue) {
+			if (!parseCount(argv[++i], options.limit))
+				return false;
+		} else if (argument == L"--engine" && hasValue) {
+			std::wstring_view value = argv[++i];
+			if (value == L"automatic")
+				options.engine = Engine::Automatic;
+			else if (value == L"scan")
+				options.engine = Engine::Scan;
+			else if (value == L"signature")
+				options.engine = Engine::Signature;
+			else if (value == L"dawg")
+				options.engine = Engine::Dawg;
+			else if (value == L"substring")
+				options.engine = Engine::Substring;
+			else if (value == L"gaddag")
+				options.engine = Engine::Gaddag;
+			else if (value == L"bitset")
+				options.engine = Engine::Bitset;
+			else
+				return false;
+		} else if (argument == L"--hooks") {
+			options.hooks = true;
+		} else if (argument == L"--moves") {
+			options.moves = true;
+		} else if (Tracing && argument == L"--trace") {
+			options.trace = true;
+		} else if (argument == L"--leaves" && hasValue) {
+			options.leaves = argv[++i];
+		} else if (argument == L"--serve" && hasValue) {
+			options.pipe = argv[++i];
+		} else if (argument.substr(0, 2) == L"--" || options.input) {
+			return false;
+		} else {
+			options.input = argv[i];
+		}
+	}
+
+	if (options.moves && (options.pipe || options.leaves || options.trace))
+		return false;
+
+	return !options.pipe
+		|| (!options.input && !options.trace && !options.leaves);
+}
+
+/**
+ * Splits an input line into a query
+ *
+ * Fields are separated by tabs, and any fields past the seventh are
+ * ignored. A last field that is not a number lets the tiles on the board sit
+ * anywhere in a word.
+ * The dictionary is uppercase, so the line is uppercased first for the
+ * filters to match regardless of case. Unless the alphabet is classic, the
+ * line is then mapped onto its tile codes.
+ *
+ * @param line is the input line, which must outlive the query
+ * @param alphabet holds the tiles the dictionary is spelled with
+ * @param query receives the letters, filters and pattern
+ * @param pattern receives the compiled pattern, which must also outlive
+ *        the query
+ */
+void parseQuery(_Inout_ std::string& line, _In_ Alphabet const& alphabet,
+	_Inout_ Query& query, _Out_ std::optional<Pattern>& pattern) {
+	for (char& character : line) {
+		if (character >= 'a' && character <= 'z')
+			character = static_cast<char>(character - 'a' + 'A');
+	}
+
+	if (!alphabet.classic())
+		line = alphabet.encode(line);
+
+	std::string_view remaining = line;
+	std::string_view text;
+	std::string_view offset;
+	std::string_view* fields[] = { &query.letters, &query.startsWith,
+		&query.endsWith, &query.contains, &text, &query.through, &offset };
+	for (std::string_view* field : fields) {
+		size_t tab = remaining.find('\t');
+		*field = remaining.substr(0, tab);
+		if (tab == std::string_view::npos)
+			remaining = {};
+		else
+			remaining.remove_prefix(tab + 1);
+	}
+
+	char const* end = offset.data() + offset.length();
+	if (offset.empty() || std::from_chars(offset.data(), end,
+		query.offset).ptr != end)
+		query.offset = Gaddag::Anywhere;
+
+	pattern.reset();
+	if (!text.empty()) {
+		pattern.emplace(text);
+		query.pattern = &*pattern;
+	}
+}
+
+/**
+ * Appends an integer to the output
+ *
+ * @param output is the text being written
+ * @param value is the integer to append
+ */
+void appendNumber(_Inout_ std::string& output, _In_ int value) {
+	char digits[16] = {};
+	char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+	output.append(digits, end);
+}
+
+/**
+ * Appends a quoted JSON string to the output
+ *
+ * @param output is the text being written
+ * @param text is the string to quote
+ */
+void appendJsonString(_Inout_ std::string& output,
+	_In_ std::string_view text) {
+	static char const digits[] = "0123456789abcdef";
+
+	output.push_back('"');
+	for (char character : text) {
+		unsigned char code = static_cast<unsigned char>(character);
+		if (character == '"' || character == '\\') {
+			output.push_back('\\');
+			output.push_back(character);
+		} else if (code < 0x20) {
+			output.append("\\u00");
+			output.push_back(digits[code >> 4]);
+			output.push_back(digits[code & 15]);
+		} else
+			output.push_back(character);
+	}
+
+	output.push_back('"');
+}
+
+/**
+ * Appends text held as tile codes to the output
+ *
+ * @param output is the text being written
+ * @param alphabet holds the tiles the codes stand for
+ * @param codes is the text to append
+ */
+void appendCodes(_Inout_ std::string& output, _In_ Alphabet const& alphabet,
+	_In_ std::string_view codes) {
+	if (alphabet.classic())
+		output.append(codes);
+	else
+		output.append(alphabet.decode(codes));
+}
+
+/**
+ * Appends text held as tile codes to the output as a quoted JSON string
+ *
+ * @param output is the text being written
+ * @param alphabet holds the tiles the codes stand for
+ * @param codes is the text to quote
+ */
+void appendJsonCodes(_Inout_ std::string& output,
+	_In_ Alphabet const& alphabet, _In_ std::string_view codes) {
+	if (alphabet.classic())
+		appendJsonString(output, codes);
+	else
+		appendJsonString(output, alphabet.decode(codes));
+}
+
+/**
+ * Appends an equity or leave value with two decimals to the output
+ *
+ * @param output is the text being written
+ * @param value is the value to append
+ */
+void appendValue(_Inout_ std::string& output, _In_ float value) {
+	char number[32] = {};
+	snprintf(number, sizeof(number), "%.2f", value);
+	output.append(number);
+}
+
+/**
+ * Opens a JSON object with the four fields of a query as its first members
+ *
+ * @param output is the text being written
+ * @param alphabet holds the tiles the fields are spelled with
+ * @param query is the query whose fields are written
+ */
+void appendJsonQuery(_Inout_ std::string& output,
+	_In_ Alphabet const& alphabet, _In_ Query const& query) {
+	output.append("{\"letters\":");
+	appendJsonCodes(output, alphabet, query.letters);
+	output.append(",\"startsWith\":");
+	appendJsonCodes(output, alphabet, query.startsWith);
+	output.append(",\"endsWith\":");
+	appendJsonCodes(output, alphabet, query.endsWith);
+	output.append(",\"contains\":");
+	appendJsonCodes(output, alphabet, query.contains);
+}
+
+/**
+ * Appends the timings and counters of a profile as JSON members
+ *
+ * Every stage is written in milliseconds and every counter as a whole
+ * number, so each line of the trace has the same members.
+ *
+ * @param output is the text being written
+ * @param profile is the profile to write
+ */
+void appendProfile(_Inout_ std::string& output, _In_ Profile const& profile) {
+	char number[32] = {};
+	for (size_t i = 0; i < StageCount; ++i) {
+		snprintf(number, sizeof(number), "%.3f",
+			profile.milliseconds(static_cast<Stage>(i)));
+		output.append(",\"");
+		output.append(StageNames[i]);
+		output.append("Ms\":");
+		output.append(number);
+	}
+
+	for (size_t i = 0; i < CounterCount; ++i) {
+		snprintf(number, sizeof(number), "%llu", static_cast<
+			unsigned long long>(profile.total(static_cast<Counter>(i))));
+		output.append(",\"");
+		output.append(CounterNames[i]);
+		output.append("\":");
+		output.append(number);
+	}
+}
+
+/**
+ * Appends the trace of a query as one line of JSON
+ *
+ * @param output is the text being written
+ * @param alphabet holds the tiles the query is spelled with
+ * @param query is the query that was solved
+ * @param profile holds the timings and counters of the query
+ */
+void appendTrace(_Inout_ std::string& output, _In_ Alphabet const& alphabet,
+	_In_ Query const& query, _In_ Profile const& profile) {
+	appendJsonQuery(output, alphabet, query);
+	output.append(",\"engine\":");
+	appendJsonString(output,
+		EngineNames[static_cast<size_t>(profile.engine())]);
+	appendProfile(output, profile);
+	output.append("}\n");
+}
+
+/**
+ * Appends the start of a tab-separated row
+ *
+ * @param output is the text being written
+ * @param alphabet holds the tiles the query and word are spelled with
+ * @param query is the query that was solved
+ * @param word is the word the row is about
+ * @param points is the score of the word
+ */
+void appendTsvRow(_Inout_ std::string& output, _In_ Alphabet const& alphabet,
+	_In_ Query const& query, _In_ std::string_view word, _In_ int points) {
+	appendCodes(output, alphabet, query.letters);
+	output.push_back('\t');
+	appendCodes(output, alphabet, query.startsWith);
+	output.push_back('\t');
+	appendCodes(output, alphabet, query.endsWith);
+	output.push_back('\t');
+	appendCodes(output, alphabet, query.contains);
+	output.push_back('\t');
+	appendCodes(output, alphabet, word);
+	output.push_back('\t');
+	appendNumber(output, points);
+}
+
+/**
+ * Appends the results of a query as tab-separated rows
+ *
+ * Every match is one row holding the query's four fields, the word and its
+ * points.
+ *
+ * @param output is the text being written
+ * @param lexicon is the dictionary the matches were found in
+ * @param query is the query that was solved
+ * @param matches are the query's matches
+ */
+void appendTsv(_Inout_ std::string& output, _In_ Lexicon const& lexicon,
+	_In_ Query const& query, _In_ MatchSpan matches) {
+	for (Match const& match : matches) {
+		appendTsvRow(output, lexicon.alphabet(), query,
+			lexicon.dictionary()[match.index], match.points);
+		output.push_back('\n');
+	}
+}
+
+/**
+ * Appends the plays of a query as tab-separated rows
+ *
+ * Every play is one row holding the query's four fields, the word, its
+ * points, the value of its leave and its equity.
+ *
+ * @param output is the text being written
+ * @param lexicon is the dictionary the plays were found in
+ * @param query is the query that was solved
+ * @param plays are the query's plays
+ */
+void appendTsv(_Inout_ std::string& output, _In_ Lexicon const& lexicon,
+	_In_ Query const& query, _In_ std::vector<Play> const& plays) {
+	for (Play const& play : plays) {
+		appendTsvRow(output, lexicon.alphabet(), query,
+			lexicon.dictionary()[play.index], play.points);
+		output.push_back('\t');
+		appendValue(output, play.leave);
+		output.push_back('\t');
+		appendValue(output, play.equity);
+		output.push_back('\n');
+	}
+}
+
+/**
+ * Appends the results of a query as one line of JSON
+ *
+ * @param output is the text being written
+ * @param lexicon is the dictionary the matches were found in
+ * @param query is the query that was solved
+ * @param matches are the query's matches
+ */
+void appendJson(_Inout_ std::string& output, _In_ Lexicon const& lexicon,
+	_In_ Query const& query, _In_ MatchSpan matches) {
+	appendJsonQuery(output, lexicon.alphabet(), query);
+	output.append(",\"matches\":[");
+	for (size_t i = 0; i < matches.size(); ++i) {
+		if (i)
+			output.push_back(',');
+
+		output.append("{\"word\":");
+		appendJsonCodes(output, lexicon.alphabet(),
+			lexicon.dictionary()[matches[i].index]);
+		output.append(",\"points\":");
+		appendNumber(output, matches[i].points);
+		output.push_back('}');
+	}
+
+	output.append("]}\n");
+}
+
+/**
+ * Appends the plays of a query as one line of JSON
+ *
+ * @param output is the text being written
+ * @param lexicon is the dictionary the plays were found in
+ * @param query is the query that was solved
+ * @param plays are the query's plays
+ */
+void appendJson(_Inout_ std::string& output, _In_ Lexicon const& lexicon,
+	_In_ Query const& query, _In_ std::vector<Play> const& plays) {
+	appendJsonQuery(output, lexicon.alphabet(), query);
+	output.append(",\"matches\":[");
+	for (size_t i = 0; i < plays.size(); ++i) {
+		if (i)
+			output.push_back(',');
+
+		output.append("{\"word\":");
+		appendJsonCodes(output, lexicon.alphabet(),
+			lexicon.dictionary()[plays[i].index]);
+		output.append(",\"points\":");
+		appendNumber(output, plays[i].points);
+		output.append(",\"leave\":");
+		appendValue(output, plays[i].leave);
+		output.append(",\"equity\":");
+		appendValue(output, plays[i].equity);
+		output.push_back('}');
+	}
+
+	output.append("]}\n");
+}
+
+/**
+ * Appends the moves of a rack as tab-separated rows
+ *
+ * Every move is one row holding the rack, the word, the row and column of
+ * its first square counting from zero, its direction and its score.
+ *
+ * @param output is the text being written
+ * @param rack is the rack the moves were found for
+ * @param moves are the rack's moves
+ */
+void appendTsv(_Inout_ std::string& output, _In_ std::string_view rack,
+	_In_ std::vector<Move> const& moves) {
+	for (Move const& move : moves) {
+		output.append(rack);
+		output.push_back('\t');
+		output.append(move.word);
+		output.push_back('\t');
+		appendNumber(output, move.row);
+		output.push_back('\t');
+		appendNumber(output, move.column);
+		output.append(move.direction == Direction::Across ? "\tacross\t"
+			: "\tdown\t");
+		appendNumber(output, move.score);
+		output.push_back('\n');
+	}
+}
+
+/**
+ * Appends the moves of a rack as one line of JSON
+ *
+ * @param output is the text being written
+ * @param rack is the rack the moves were found for
+ * @param moves are the rack's moves
+ */
+void appendJson(_Inout_ std::string& output, _In_ std::string_view rack,
+	_In_ std::vector<Move> const& moves) {
+	output.append("{\"letters\":");
+	appendJsonString(output, rack);
+	output.append(",\"moves\":[");
+	for (size_t i = 0; i < moves.size(); ++i) {
+		if (i)
+			output.push_back(',');
+
+		output.append("{\"word\":");
+		appendJsonString(output, moves[i].word);
+		output.append(",\"row\":");
+		appendNumber(output, moves[i].row);
+		output.append(",\"column\":");
+		appendNumber(output, moves[i].column);
+		output.append(moves[i].direction == Direction::Across
+			? ",\"direction\":\"across\"" : ",\"direction\":\"down\"");
+		output.append(",\"score\":");
+		appendNumber(output, moves[i].score);
+		output.push_back('}');
+	}
+
+	output.append("]}\n");
+}
+
+/**
+ * Plays a game from an empty board
+ *
+ * Every line is a turn, and its first field is the rack. All the moves of
+ * the rack are written, or only the best ones if there is a limit, and then
+ * the best move is played, so the next line sees the board it leaves. A
+ * rack with no move passes and leaves the board as it is. Blanks are
+ * written as question marks, and the letters they are played as are
+ * lowercase in the words written.
+ *
+ * @param lexicon is the dictionary whose word graph the board checks
+ *        words against
+ * @param options contains the output layout and limit
+ * @param input holds one rack per line
+ * @return exit status, which is 1 if the dictionary is not spelled with
+ *         the classic alphabet
+ */
+int play(_In_ Lexicon const& lexicon, _In_ Options const& options,
+	_Inout_ std::istream& input) {
+	if (!lexicon.alphabet().classic()) {
+		fputs("Moves need the classic alphabet\n", stderr);
+		return 1;
+	}
+
+	Board board(lexicon.dawg());
+	std::string output;
+	std::string line;
+	while (std::getline(input, line)) {
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+
+		std::string_view rack = std::string_view(line).substr(0,
+			line.find('\t'));
+		if (rack.empty())
+			continue;
+
+		std::vector<Move> moves = generateMoves(board, rack);
+		if (!moves.empty())
+			board.play(moves.front());
+		if (options.limit && moves.size() > options.limit)
+			moves.resize(options.limit);
+
+		if (options.format == Format::Json)
+			appendJson(output, rack, moves);
+		else
+			appendTsv(output, rack, moves);
+
+		if (output.size() >= 1 << 20) {
+			fwrite(output.data(), 1, output.size(), stdout);
+			output.clear();
+		}
+	}
+
+	fwrite(output.data(), 1, output.size(), stdout);
+	fflush(stdout);
+	return 0;
+}
+
+/**
+ * Number of clients being answered, which the server waits on before it
+ * lets the lexicon they search go out of scope
+ */
+struct Clients {
+	std::mutex mutex;
+	std::condition_variable idle;
+	size_t active = 0;
+};
+
+/**
+ * Writes an entire buffer to a pipe
+ *
+ * @param pipe is the connected pipe
+ * @param output is the text to write
+ * @return false if the client went away
+ */
+bool writePipe(_In_ HANDLE pipe, _In_ std::string_view output) {
+	while (!output.empty()) {
+		DWORD written = 0;
+		DWORD size = static_cast<DWORD>(std::min<size_t>(output.size(),
+			1 << 20));
+		if (!WriteFile(pipe, output.data(), size, &written, nullptr))
+			return false;
+
+		output.remove_prefix(written);
+	}
+
+	return true;
+}
+
+/**
+ * Answers the queries of one client until it disconnects
+ *
+ * Clients may send any number of lines without waiting for the answers.
+ * Every complete line that has arrived is solved together as one batch, so
+ * words that are scanned for are read once for the whole batch, and the
+ * answers are written back in the order the lines were sent. The lexicon is
+ * only read, so every client searches the same one and only holds its own
+ * buffers.
+ *
+ * @param pipe is the pipe connected to the client, which is closed
+ *        afterwards
+ * @param lexicon is the dictionary and indexes to search
+ * @param options contains the output layout, sorting method, engine and
+ *        limit of every query
+ * @param clients is told when the client is done
+ */
+void answer(_In_ HANDLE pipe, _In_ Lexicon const& lexicon,
+	_In_ Options const& options, _Inout_ Clients& clients) {
+	std::vector<char> buffer(1 << 16);
+	std::string pending;
+	std::string output;
+	std::vector<std::string> lines;
+	std::vector<Query> queries;
+	std::vector<std::optional<Pattern>> patterns;
+	DWORD read = 0;
+	while (ReadFile(pipe, buffer.data(), static_cast<DWORD>(buffer.size()),
+		&read, nullptr) && read) {
+		pending.append(buffer.data(), read);
+		size_t end = pending.rfind('\n');
+		if (end == std::string::npos)
+			continue;
+
+		lines.clear();
+		for (size_t begin = 0; begin <= end;) {
+			size_t next = pending.find('\n', begin);
+			std::string& line =
+				lines.emplace_back(pending, begin, next - begin);
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+			if (line.empty())
+				lines.pop_back();
+
+			begin = next + 1;
+		}
+
+		pending.erase(0, end + 1);
+		queries.assign(lines.size(), Query());
+		patterns.resize(lines.size());
+		for (size_t i = 0; i < lines.size(); ++i) {
+			parseQuery(lines[i], lexicon.alphabet(), queries[i], patterns[i]);
+			queries[i].method = options.method;
+			queries[i].engine = options.engine;
+			queries[i].limit = options.limit;
+			queries[i].hook = options.hooks;
+		}
+
+		std::vector<std::vector<Match>> results =
+			solveBatch(lexicon, queries);
+		output.clear();
+		for (size_t i = 0; i < queries.size(); ++i) {
+			if (options.format == Format::Json) {
+				appendJson(output, lexicon, queries[i], results[i]);
+			} else {
+				appendTsv(output, lexicon, queries[i], results[i]);
+				output.push_back('\n');
+			}
+		}
+
+		if (!writePipe(pipe, output))
+			break;
+	}
+
+	FlushFileBuffers(pipe);
+	DisconnectNamedPipe(pipe);
+	CloseHandle(pipe);
+
+	std::lock_guard<std::mutex> lock(clients.mutex);
+	if (--clients.active == 0)
+		clients.idle.notify_all();
+}
+
+/**
+ * Answers clients of a named pipe until the pipe cannot be created
+ *
+ * A new instance of the pipe is created for every client that connects, and
+ * each client is answered on its own thread. Only clients on the same
+ * machine are accepted.
+ *
+ * @param lexicon is the dictionary and indexes to search
+ * @param options contains the name of the pipe and the settings of every
+ *        query
+ * @return exit status, which is 2 if the pipe cannot be created
+ */
+int serve(_In_ Lexicon const& lexicon, _In_ Options const& options) {
+	std::wstring name = L"\\\\.\\pipe\\";
+	name.append(options.pipe);
+
+	Clients clients;
+	while (true) {
+		HANDLE pipe = CreateNamedPipeW(name.c_str(), PIPE_ACCESS_DUPLEX,
+			PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT
+			| PIPE_REJECT_REMOTE_CLIENTS, PIPE_UNLIMITED_INSTANCES, 1 << 16,
+			1 << 16, 0, nullptr);
+		if (pipe == INVALID_HANDLE_VALUE)
+			break;
+
+		if (!ConnectNamedPipe(pipe, nullptr)
+			&& GetLastError() != ERROR_PIPE_CONNECTED) {
+			CloseHandle(pipe);
+			continue;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(clients.mutex);
+			++clients.active;
+		}
+
+		std::thread(answer, pipe, std::cref(lexicon), std::cref(options),
+			std::ref(clients)).detach();
+	}
+
+	fputs("Could not create the pipe\n", stderr);
+	std::unique_lock<std::mutex> lock(clients.mutex);
+	clients.idle.wait(lock, [&clients] {
+		return clients.active == 0;
+	});
+	return 2;
+}
+
+/**
+ * Program entry-point
+ *
+ * The dictionary is loaded once, then every query is solved
+ * against it in turn through one workspace, so solving reuses the same
+ * memory for every line. Output is collected in a buffer that is written out
+ * in large blocks rather than line by line. When tracing, every query is
+ * profiled and its trace, including the time taken to format its results,
+ * is collected the same way for standard error, after a first line for
+ * loading the dictionary. When serving, queries come from the pipe
+ * instead. Given a leave table, every query is ranked by equity instead of
+ * by the sorting method, and a rack of more than seven tiles is reported
+ * and answered with no plays. When playing a game, every line is a rack
+ * whose moves are found on the board instead. A dictionary spelled with
+ * another alphabet has its queries and results mapped onto and back from its
+ * tiles.
+ *
+ * @param argc is the number of arguments
+ * @param argv contains the arguments
+ * @return exit status, which is 1 for bad arguments and 2 if the dictionary
+ *         or input file cannot be read or the pipe cannot be created
+ */
+int wmain(_In_ int argc, _In_reads_(argc) wchar_t* argv[]) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) {
+		printUsage();
+		return 1;
+	}
+
+	Profile loading;
+	Lexicon lexicon = [&] {
+		ScopedTimer timer(&loading, Stage::Load);
+		return options.dictionary
+			? loadLexicon(options.dictionary)
+			: loadLexicon(GetModuleHandleW(nullptr), ID_DICTIONARY);
+	}();
+	if (lexicon.dictionary().empty()) {
+		fputs("Could not load the dictionary\n", stderr);
+		return 2;
+	}
+
+	if (options.pipe)
+		return serve(lexicon, options);
+
+	LeaveTable leaves;
+	if (options.leaves) {
+		if (!lexicon.alphabet().classic()) {
+			fputs("Leave tables need the classic alphabet\n", stderr);
+			return 1;
+		}
+
+		leaves = loadLeaves(options.leaves);
+		if (leaves.empty()) {
+			fputs("Could not load the leave table\n", stderr);
+			return 2;
+		}
+	}
+
+	std::ifstream file;
+	if (options.input) {
+		file.open(std::filesystem::path(options.input), std::ios::binary);
+		if (!file) {
+			fputs("Could not open the input file\n", stderr);
+			return 2;
+		}
+	}
+
+	std::istream& input = options.input ? file : std::cin;
+	_setmode(_fileno(stdout), _O_BINARY);
+	if (options.moves)
+		return play(lexicon, options, input);
+
+	Workspace workspace;
+	std::string output;
+	std::string trace;
+	std::string line;
+	std::optional<Pattern> pattern;
+	if (options.trace) {
+		trace.append("{\"words\":");
+		appendNumber(trace, static_cast<int>(lexicon.dictionary().size()));
+		appendProfile(trace, loading);
+		trace.append("}\n");
+	}
+
+	while (std::getline(input, line)) {
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+		if (line.empty())
+			continue;
+
+		Query query;
+		parseQuery(line, lexicon.alphabet(), query, pattern);
+		query.method = options.method;
+		query.engine = options.engine;
+		query.limit = options.limit;
+		query.hook = options.hooks;
+
+		Profile profile;
+		if (options.trace)
+			query.profile = &profile;
+
+		if (options.leaves) {
+			if (!fitsRack(query.letters))
+				fputs("Racks ranked by equity hold at most seven tiles\n",
+					stderr);
+
+			std::vector<Play> plays = evaluate(lexicon, leaves, query);
+			ScopedTimer timer(query.profile, Stage::Format);
+			if (options.format == Format::Json)
+				appendJson(output, lexicon, query, plays);
+			else
+				appendTsv(output, lexicon, query, plays);
+		} else {
+			MatchSpan matches = solve(lexicon, query, workspace);
+			ScopedTimer timer(query.profile, Stage::Format);
+			if (options.format == Format::Json)
+				appendJson(output, lexicon, query, matches);
+			else
+				appendTsv(output, lexicon, query, matches);
+		}
+
+		if (options.trace)
+			appendTrace(trace, lexicon.alphabet(), query, profile);
+
+		if (output.size() >= 1 << 20) {
+			fwrite(output.data(), 1, output.size(), stdout);
+			output.clear();
+		}
+
+		if (trace.size() >= 1 << 20) {
+			fwrite(trace.data(), 1, trace.size(), stderr);
+			trace.clear();
+		}
+	}
+
+	fwrite(output.data(), 1, output.size(), stdout);
+	fflush(stdout);
+	fwrite(trace.data(), 1, trace.size(), stderr);
+	return 0;
+}